@@ -0,0 +1,670 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+/* Host microbenchmark for every nanoparse_* parser and serializer.
+ *
+ *   nano_parse_bench [--check] [--time-ms N] [filter]
+ *
+ * Reports ns/op, input MB/s and heap allocations/op. The corpus is the
+ * node responses from the unit tests plus generated large pending,
+ * frontier and blocks_info maps. --check runs each case once and exits
+ * non-zero if any of them fails to parse. */
+
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sodium.h>
+
+#include "nano_lib.h"
+#include "jolttypes.h"
+#include "nano_parse.h"
+
+/* Generated corpus sizes */
+#define BENCH_FRONTIERS 256
+#define BENCH_PENDING_ACCOUNTS 16
+#define BENCH_PENDING_BLOCKS 16
+#define BENCH_BLOCKS_INFO 32
+#define BENCH_STREAM_CHUNK 256
+#define BENCH_CORPUS_BUF_LEN 131072
+
+/**********************
+ * Allocation counter *
+ **********************/
+/* Interposes the libc allocator so allocations inside cJSON, mbedtls and
+ * libsodium are counted as well as our own. */
+static size_t n_allocs;
+
+#if defined(__GLIBC__)
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+void *malloc(size_t size) {
+    n_allocs++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+    n_allocs++;
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    n_allocs++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+    __libc_free(ptr);
+}
+#define BENCH_COUNTS_ALLOCS 1
+#else
+#define BENCH_COUNTS_ALLOCS 0
+#endif
+
+/**********
+ * Corpus *
+ **********/
+static const char json_block_count[] =
+        "{\n"
+        "    \"count\": \"9493688\",\n"
+        "    \"unchecked\": \"18360\"\n"
+        "}\n";
+static const char json_work[] =
+        "{\n"
+        "    \"work\": \"bf0dc663d15668b6\"\n"
+        "}\n";
+static const char json_account_frontier[] =
+        "{\n"
+        "    \"frontiers\": {\n"
+        "        \"xrb_3tw77cfpwfnkqrjb988sh91tzerwu5dfnzxy8b3u76r7a7xwnkawm37ctcsb\": \"33832030C4F99FD37C8CD8399911D47150FCB90AE3A791970DBC8D05DFF93B8B\"\n"
+        "    }\n"
+        "}\n";
+static const char json_account_info[] =
+        "{\n"
+        "    \"frontier\": \"FF84533A571D953A596EA401FD41743AC85D04F406E76FDE4408EAED50B473C5\",\n"
+        "    \"open_block\": \"991CF190094C00F0B68E2E5F75F6BEE95A2E0BD93CEAA4A6734DB9F19B728948\",\n"
+        "    \"representative_block\": \"991CF190094C00F0B68E2E5F75F6BEE95A2E0BD93CEAA4A6734DB9F19B728948\",\n"
+        "    \"balance\": \"235580100176034320859259343606608761791\",\n"
+        "    \"modified_timestamp\": \"1501793775\",\n"
+        "    \"block_count\": \"33\",\n"
+        "    \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\"\n"
+        "}\n";
+static const char json_account_balance[] =
+        "{\n"
+        "    \"balance\": \"10000\",\n"
+        "    \"pending\": \"340282366920938463463374607431768211455\"\n"
+        "}\n";
+static const char json_pending_hash[] =
+        "{\n"
+        "    \"blocks\": {\n"
+        "        \"xrb_1111111111111111111111111111111111111111111111111111hifc8npp\": {\n"
+        "            \"00003F1C2F438F98F77771BBD140A58E976BF7A3B2D8EA8D9016DA7AED92EB14\": {\n"
+        "                \"amount\": \"1\",\n"
+        "                \"source\": \"xrb_1hnt56nto4id54wt66rpttwd4xgmzucohdpeacc3yzrnzr9g1tm9tkk9s8jc\"\n"
+        "            }\n"
+        "        }\n"
+        "    }\n"
+        "}\n";
+static const char json_open[] =
+        "{\n"
+        "    \"contents\": \"{\\n"
+        "    \\\"type\\\": \\\"open\\\",\\n"
+        "    \\\"source\\\": \\\"32E0D2FE367522FBFA29EB93940EC3AE5E1315DD9C6A73B3DE2A8BC683B64367\\\",\\n"
+        "    \\\"representative\\\": \\\"xrb_3hd4ezdgsp15iemx7h81in7xz5tpxi43b6b41zn3qmwiuypankocw3awes5k\\\",\\n"
+        "    \\\"account\\\": \\\"xrb_3dmtrrws3pocycmbqwawk6xs7446qxa36fcncush4s1pejk16ksbmakis78m\\\",\\n"
+        "    \\\"work\\\": \\\"21bcc2816e10165d\\\",\\n"
+        "    \\\"signature\\\": \\\"2CA07C59BF80B04515D49480EF0B5918BA29F998AB84120BB4B33A1A49BC028F0DB86CED729BF17B2CFF64F92011DC7F0089CDBF283C392F242A9F42DFA66000\\\"\\n"
+        "}\\n"
+        "\"\n"
+        "}\n";
+static const char json_send[] =
+        "{\n"
+        "    \"contents\": \"{\\n"
+        "    \\\"type\\\": \\\"send\\\",\\n"
+        "    \\\"previous\\\": \\\"66B2E0C0D2971A6372184FC851C959D4A2993749C78BA845D707873FB2C2EFDA\\\",\\n"
+        "    \\\"destination\\\": \\\"xrb_3h94iuxwu48uzokokwa991a3okkwypiugsb5a1ehzwfw33dxrsuu154iw5qr\\\",\\n"
+        "    \\\"balance\\\": \\\"0000000694140DC0A578AED10D000000\\\",\\n"
+        "    \\\"work\\\": \\\"595ebaa13f83c1b2\\\",\\n"
+        "    \\\"signature\\\": \\\"E523F20CAC1FF563F697C1D58E60FF0D72A9AC7B499799785490648E3F154FE4F464F6D7ECC4CD1A8072827E88F3D5805A8370F4A6DE06EDA8939E70E5113803\\\"\\n"
+        "}\\n"
+        "\"\n"
+        "}\n";
+static const char json_receive[] =
+        "{\n"
+        "    \"contents\": \"{\\n"
+        "    \\\"type\\\": \\\"receive\\\",\\n"
+        "    \\\"previous\\\": \\\"755F515E56D7AE5467D454C61304320CA7363449580DE3B40B0F51C816C9A8F9\\\",\\n"
+        "    \\\"source\\\": \\\"58C5B5344D85AAAEF1E7980B25E93DFB4834B6185EAD9A546D43F400370E1188\\\",\\n"
+        "    \\\"work\\\": \\\"0c6589b8125613d8\\\",\\n"
+        "    \\\"signature\\\": \\\"14EF1B6FA1CCD0B56EC2D8213A0708701BA322C3C3CB592D5C85D005CD3D51F24F4EE5954FE3C1EB5839004B7541E742AA1F7870FD81220A02319B96105D2D04\\\"\\n"
+        "}\\n"
+        "\"\n"
+        "}\n";
+static const char json_change[] =
+        "{\n"
+        "    \"contents\": \"{\\n"
+        "    \\\"type\\\": \\\"change\\\",\\n"
+        "    \\\"previous\\\": \\\"AF9C1D46AAE66CC8F827904ED02D4B3D95AA98B1FF058352BA6B670BEFD40231\\\",\\n"
+        "    \\\"representative\\\": \\\"xrb_1cwswatjifmjnmtu5toepkwca64m7qtuukizyjxsghujtpdr9466wjmn89d8\\\",\\n"
+        "    \\\"work\\\": \\\"e8c2c556c9cfb6e2\\\",\\n"
+        "    \\\"signature\\\": \\\"A039A7BF5E54B44F45A8E1AD9940A81C87CC66C04AFA738367956629A5EF49E49D297FA3CDD195BDA8373D144F9E1D4641737E7F372CEAB5AD2F3B8E9852A30D\\\"\\n"
+        "}\\n"
+        "\"\n"
+        "}\n";
+static const char json_state[] =
+        "{\n"
+        "    \"contents\": \"{\\n"
+        "    \\\"type\\\": \\\"state\\\",\\n"
+        "    \\\"account\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n"
+        "    \\\"previous\\\": \\\"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\\\",\\n"
+        "    \\\"representative\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n"
+        "    \\\"balance\\\": \\\"0\\\",\\n"
+        "    \\\"link\\\": \\\"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\\\",\\n"
+        "    \\\"link_as_account\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n"
+        "    \\\"signature\\\": \\\"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\\\",\\n"
+        "    \\\"work\\\": \\\"6aa2c8a6e053c0d4\\\"\\n"
+        "}\\n"
+        "\"\n"
+        "}\n";
+static const char json_state_object[] =
+        "{\n"
+        "    \"contents\": {\n"
+        "        \"type\": \"state\",\n"
+        "        \"account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\",\n"
+        "        \"previous\": \"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\",\n"
+        "        \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\",\n"
+        "        \"balance\": \"0\",\n"
+        "        \"link\": \"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\",\n"
+        "        \"link_as_account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\",\n"
+        "        \"signature\": \"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\",\n"
+        "        \"work\": \"6aa2c8a6e053c0d4\"\n"
+        "    }\n"
+        "}\n";
+
+static char json_frontiers[BENCH_CORPUS_BUF_LEN];
+static char json_accounts_pending[BENCH_CORPUS_BUF_LEN];
+static char json_blocks_info[BENCH_CORPUS_BUF_LEN];
+static uint256_t blocks_info_hashes[BENCH_BLOCKS_INFO];
+
+static void corpus_append(char *buf, size_t *len, const char *fmt, ...) {
+    va_list args;
+    int n;
+
+    va_start(args, fmt);
+    n = vsnprintf(buf + *len, BENCH_CORPUS_BUF_LEN - *len, fmt, args);
+    va_end(args);
+    if( n < 0 || *len + n >= BENCH_CORPUS_BUF_LEN ) {
+        fprintf(stderr, "corpus buffer too small\n");
+        exit(EXIT_FAILURE);
+    }
+    *len += n;
+}
+
+/* Deterministic 32 bytes per (kind, i) */
+static void corpus_bytes(uint256_t out, uint8_t kind, uint32_t i) {
+    uint8_t seed[5] = { kind, i >> 24, i >> 16, i >> 8, i };
+    crypto_generichash(out, sizeof(uint256_t), seed, sizeof(seed), NULL, 0);
+}
+
+static void corpus_hash(char *hex, uint8_t kind, uint32_t i) {
+    uint256_t bin;
+    corpus_bytes(bin, kind, i);
+    sodium_bin2hex(hex, HEX_256, bin, sizeof(bin));
+    for( ; *hex; hex++ ) {
+        if( *hex >= 'a' && *hex <= 'f' ) {
+            *hex -= 'a' - 'A';
+        }
+    }
+}
+
+static void corpus_address(char *address, uint8_t kind, uint32_t i) {
+    uint256_t pub;
+    corpus_bytes(pub, kind, i);
+    nl_public_to_address(address, ADDRESS_BUF_LEN, pub);
+}
+
+static void corpus_init(void) {
+    /* Pretty-printed like nano_node, which is what goes over the wire */
+    char address[ADDRESS_BUF_LEN], source[ADDRESS_BUF_LEN];
+    hex256_t hash;
+    size_t len;
+
+    len = 0;
+    corpus_append(json_frontiers, &len, "{\n    \"frontiers\": {\n");
+    for( uint32_t i = 0; i < BENCH_FRONTIERS; i++ ) {
+        corpus_address(address, 'a', i);
+        corpus_hash(hash, 'f', i);
+        corpus_append(json_frontiers, &len, "        \"%s\": \"%s\"%s\n",
+                address, hash, i + 1 < BENCH_FRONTIERS ? "," : "");
+    }
+    corpus_append(json_frontiers, &len, "    }\n}\n");
+
+    len = 0;
+    corpus_append(json_accounts_pending, &len, "{\n    \"blocks\": {\n");
+    for( uint32_t i = 0; i < BENCH_PENDING_ACCOUNTS; i++ ) {
+        corpus_address(address, 'a', i);
+        corpus_append(json_accounts_pending, &len, "        \"%s\": {\n", address);
+        for( uint32_t j = 0; j < BENCH_PENDING_BLOCKS; j++ ) {
+            uint32_t n = i * BENCH_PENDING_BLOCKS + j;
+            corpus_hash(hash, 'p', n);
+            corpus_address(source, 's', n);
+            corpus_append(json_accounts_pending, &len,
+                    "            \"%s\": {\n"
+                    "                \"amount\": \"%u000000000000000000000000000\",\n"
+                    "                \"source\": \"%s\"\n"
+                    "            }%s\n",
+                    hash, n + 1, source, j + 1 < BENCH_PENDING_BLOCKS ? "," : "");
+        }
+        corpus_append(json_accounts_pending, &len, "        }%s\n",
+                i + 1 < BENCH_PENDING_ACCOUNTS ? "," : "");
+    }
+    corpus_append(json_accounts_pending, &len, "    }\n}\n");
+
+    len = 0;
+    corpus_append(json_blocks_info, &len, "{\n    \"blocks\": {\n");
+    for( uint32_t i = 0; i < BENCH_BLOCKS_INFO; i++ ) {
+        hex256_t previous, link;
+        corpus_bytes(blocks_info_hashes[i], 'b', i);
+        sodium_bin2hex(hash, sizeof(hash), blocks_info_hashes[i], sizeof(uint256_t));
+        corpus_address(address, 'a', i);
+        corpus_hash(previous, 'v', i);
+        corpus_hash(link, 'l', i);
+        corpus_append(json_blocks_info, &len,
+                "        \"%s\": {\n"
+                "            \"block_account\": \"%s\",\n"
+                "            \"amount\": \"1000000000000000000000000000000\",\n"
+                "            \"balance\": \"%u000000000000000000000000000000\",\n"
+                "            \"height\": \"%u\",\n"
+                "            \"local_timestamp\": \"1551532723\",\n"
+                "            \"confirmed\": \"true\",\n"
+                "            \"contents\": {\n"
+                "                \"type\": \"state\",\n"
+                "                \"account\": \"%s\",\n"
+                "                \"previous\": \"%s\",\n"
+                "                \"representative\": \"%s\",\n"
+                "                \"balance\": \"%u000000000000000000000000000000\",\n"
+                "                \"link\": \"%s\",\n"
+                "                \"link_as_account\": \"%s\",\n"
+                "                \"signature\": \"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\",\n"
+                "                \"work\": \"6aa2c8a6e053c0d4\"\n"
+                "            },\n"
+                "            \"subtype\": \"send\"\n"
+                "        }%s\n",
+                hash, address, i + 1, i + 1, address, previous, address, i + 1,
+                link, address, i + 1 < BENCH_BLOCKS_INFO ? "," : "");
+    }
+    corpus_append(json_blocks_info, &len, "    }\n}\n");
+}
+
+/*********
+ * Cases *
+ *********/
+static nl_block_t bench_block;
+static nl_block_t bench_blocks[BENCH_BLOCKS_INFO];
+static nanoparse_frontier_t bench_frontiers[BENCH_FRONTIERS];
+static char bench_process_buf[1024];
+static size_t bench_pending_count;
+
+static jolt_err_t bench_pending_cb(const uint256_t account,
+        const uint256_t block_hash, const nanoparse_amount_t *amount,
+        const uint256_t source, void *ctx) {
+    bench_pending_count++;
+    return E_SUCCESS;
+}
+
+static jolt_err_t run_block_count(const char *json) {
+    return nanoparse_block_count(json) > 0 ? E_SUCCESS : E_FAILURE;
+}
+
+static jolt_err_t run_work(const char *json) {
+    uint64_t work;
+    return nanoparse_work(json, &work);
+}
+
+static jolt_err_t run_account_frontier(const char *json) {
+    hex256_t frontier;
+    return nanoparse_account_frontier(json, frontier);
+}
+
+static jolt_err_t run_account_frontiers(const char *json) {
+    size_t n;
+    jolt_err_t res = nanoparse_account_frontiers(json, bench_frontiers,
+            BENCH_FRONTIERS, &n);
+    return (E_SUCCESS == res && BENCH_FRONTIERS == n) ? E_SUCCESS : E_FAILURE;
+}
+
+static jolt_err_t run_account_info(const char *json) {
+    nanoparse_account_info_t info;
+    return nanoparse_account_info(json, &info);
+}
+
+static jolt_err_t run_account_balance(const char *json) {
+    nanoparse_account_balance_t balance;
+    return nanoparse_account_balance(json, &balance);
+}
+
+static jolt_err_t run_block(const char *json) {
+    return nanoparse_block(json, &bench_block);
+}
+
+static jolt_err_t run_block_arena(const char *json) {
+    static uint8_t buf[16384];
+    static nanoparse_arena_t arena;
+    jolt_err_t res;
+
+    if( NULL == arena.buf ) {
+        nanoparse_arena_init(&arena, buf, sizeof(buf));
+    }
+    nanoparse_arena_attach(&arena);
+    res = nanoparse_block(json, &bench_block);
+    nanoparse_arena_attach(NULL);
+    return res;
+}
+
+static jolt_err_t run_block_and_hash(const char *json) {
+    uint256_t hash;
+    return nanoparse_block_and_hash(json, &bench_block, hash);
+}
+
+static jolt_err_t run_block_partial(const char *json) {
+    return nanoparse_block_partial(json,
+            NANOPARSE_BLOCK_PREVIOUS | NANOPARSE_BLOCK_BALANCE, &bench_block, NULL);
+}
+
+static jolt_err_t run_blocks_info(const char *json) {
+    return nanoparse_blocks_info(json, blocks_info_hashes, BENCH_BLOCKS_INFO,
+            bench_blocks);
+}
+
+static jolt_err_t run_pending_hash(const char *json) {
+    hex256_t hash;
+    nanoparse_amount_t amount;
+    return nanoparse_pending_hash_amount(json, hash, &amount);
+}
+
+static jolt_err_t run_accounts_pending(const char *json) {
+    jolt_err_t res;
+    bench_pending_count = 0;
+    res = nanoparse_accounts_pending(json, bench_pending_cb, NULL);
+    if( E_SUCCESS == res
+            && BENCH_PENDING_ACCOUNTS * BENCH_PENDING_BLOCKS != bench_pending_count ) {
+        res = E_FAILURE;
+    }
+    return res;
+}
+
+static jolt_err_t run_accounts_pending_stream(const char *json) {
+    static nanoparse_stream_t s;
+    size_t len = strlen(json);
+    jolt_err_t res = E_SUCCESS;
+
+    bench_pending_count = 0;
+    nanoparse_accounts_pending_stream_init(&s, bench_pending_cb, NULL);
+    for( size_t i = 0; i < len && E_SUCCESS == res; i += BENCH_STREAM_CHUNK ) {
+        res = nanoparse_stream_feed(&s, &json[i],
+                len - i < BENCH_STREAM_CHUNK ? len - i : BENCH_STREAM_CHUNK);
+    }
+    if( E_SUCCESS == res ) {
+        res = nanoparse_stream_finish(&s);
+    }
+    if( E_SUCCESS == res
+            && BENCH_PENDING_ACCOUNTS * BENCH_PENDING_BLOCKS != bench_pending_count ) {
+        res = E_FAILURE;
+    }
+    return res;
+}
+
+static jolt_err_t run_process(const char *json) {
+    return nanoparse_process(&bench_block, bench_process_buf, sizeof(bench_process_buf));
+}
+
+static jolt_err_t run_process_len(const char *json) {
+    return nanoparse_process_len(&bench_block) > 0 ? E_SUCCESS : E_FAILURE;
+}
+
+static jolt_err_t run_amount_round_trip(const char *json) {
+    nanoparse_amount_t amount;
+    char buf[NANOPARSE_AMOUNT_DEC_BUF_LEN];
+    if( E_SUCCESS != nanoparse_amount_from_dec(&amount, json, strlen(json)) ) {
+        return E_FAILURE;
+    }
+    return nanoparse_amount_to_dec(buf, sizeof(buf), &amount);
+}
+
+static uint256_t bench_work_root;
+
+static jolt_err_t run_work_value(const char *json) {
+    static volatile uint64_t sink;
+    sink = nanoparse_work_value(bench_work_root, sink);
+    return E_SUCCESS;
+}
+
+#define BENCH_WORK_VALIDATE 32
+static uint256_t bench_validate_roots[BENCH_WORK_VALIDATE];
+static uint64_t bench_validate_works[BENCH_WORK_VALIDATE];
+
+static jolt_err_t run_work_validate(const char *json) {
+    return nanoparse_work_validate(bench_validate_roots, bench_validate_works,
+            BENCH_WORK_VALIDATE, 0, NULL);
+}
+
+/* Copies of the state block; one account, as in a chain's history */
+#define BENCH_VERIFY 32
+static nl_block_t bench_verify_blocks[BENCH_VERIFY];
+
+static jolt_err_t run_verify_each(const char *json) {
+    for( size_t i = 0; i < BENCH_VERIFY; i++ ) {
+        if( E_SUCCESS != nanoparse_block_verify(&bench_verify_blocks[i]) ) {
+            return E_FAILURE;
+        }
+    }
+    return E_SUCCESS;
+}
+
+static jolt_err_t run_verify_batch(const char *json) {
+    return nanoparse_blocks_verify(bench_verify_blocks, BENCH_VERIFY, 1, NULL);
+}
+
+typedef struct bench_case_t {
+    const char *name;
+    jolt_err_t (*run)(const char *json);
+    const char *json;  // Input; NULL for serializers
+} bench_case_t;
+
+static const bench_case_t cases[] = {
+    { "block_count",               run_block_count, json_block_count },
+    { "work",                      run_work, json_work },
+    { "account_frontier",          run_account_frontier, json_account_frontier },
+    { "account_frontiers/256",     run_account_frontiers, json_frontiers },
+    { "account_info",              run_account_info, json_account_info },
+    { "account_balance",           run_account_balance, json_account_balance },
+    { "block/open",                run_block, json_open },
+    { "block/send",                run_block, json_send },
+    { "block/receive",             run_block, json_receive },
+    { "block/change",              run_block, json_change },
+    { "block/state",               run_block, json_state },
+    { "block/state_json_block",    run_block, json_state_object },
+    { "block/state (arena)",       run_block_arena, json_state },
+    { "block_and_hash/state",      run_block_and_hash, json_state },
+    { "block_and_hash/send",       run_block_and_hash, json_send },
+    { "block_partial/state (previous+balance)", run_block_partial, json_state },
+    { "block_partial/send (previous+balance)", run_block_partial, json_send },
+    { "blocks_info/32",            run_blocks_info, json_blocks_info },
+    { "pending_hash",              run_pending_hash, json_pending_hash },
+    { "accounts_pending/16x16",    run_accounts_pending, json_accounts_pending },
+    { "accounts_pending_stream/16x16", run_accounts_pending_stream, json_accounts_pending },
+    { "process",                   run_process, NULL },
+    { "process_len",               run_process_len, NULL },
+    { "amount_dec_round_trip",     run_amount_round_trip, "235580100176034320859259343606608761791" },
+    { "work_value",                run_work_value, "" },
+    { "work_validate/32",          run_work_validate, "" },
+    { "verify/32 (one by one)",    run_verify_each, "" },
+    { "verify/32 (batch)",         run_verify_batch, "" },
+};
+
+/***********
+ * Harness *
+ ***********/
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static bool bench_run(const bench_case_t *c, uint64_t min_ns) {
+    size_t bytes = c->json ? strlen(c->json) : 0;
+    uint64_t iters = 1, start, elapsed;
+    size_t allocs;
+    double ns_per_op;
+
+    if( E_SUCCESS != c->run(c->json) ) {
+        printf("%-32s FAILED\n", c->name);
+        return false;
+    }
+    if( NULL == c->json ) {
+        bytes = strlen(bench_process_buf);
+    }
+
+    for( ;; ) {
+        n_allocs = 0;
+        start = now_ns();
+        for( uint64_t i = 0; i < iters; i++ ) {
+            c->run(c->json);
+        }
+        elapsed = now_ns() - start;
+        allocs = n_allocs;
+        if( elapsed >= min_ns || iters >= (1ULL << 40) ) {
+            break;
+        }
+        iters *= 2;
+    }
+
+    ns_per_op = (double)elapsed / iters;
+    printf("%-32s %12.1f ns/op %10.1f MB/s", c->name, ns_per_op,
+            bytes * 1e3 / ns_per_op);
+    if( BENCH_COUNTS_ALLOCS ) {
+        printf(" %10.2f allocs/op\n", (double)allocs / iters);
+    }
+    else {
+        printf("        n/a allocs/op\n");
+    }
+    return true;
+}
+
+/* Local proof-of-work throughput. An easy threshold keeps each search short
+ * so the rate is measured over many of them */
+#define BENCH_POW_THRESHOLD 0xfff0000000000000ULL
+
+static bool bench_pow(uint8_t n_threads, uint64_t min_ns) {
+    nanoparse_work_opts_t opts = { 0 };
+    uint64_t hashes = 0, start, elapsed, n, work;
+    uint8_t cores = n_threads;
+
+    opts.threshold = BENCH_POW_THRESHOLD;
+    opts.n_threads = n_threads;
+    if( 0 == cores ) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        cores = online < 1 ? 1 : (online > 64 ? 64 : online);
+    }
+
+    start = now_ns();
+    do {
+        if( E_SUCCESS != nanoparse_work_generate(bench_work_root, &opts, &work, &n)
+                || nanoparse_work_value(bench_work_root, work) < opts.threshold ) {
+            printf("pow/%-28u FAILED\n", cores);
+            return false;
+        }
+        hashes += n;
+        elapsed = now_ns() - start;
+    } while( elapsed < min_ns );
+
+    printf("pow/%-28u %12.2f MH/s %10.2f MH/s/core\n", cores,
+            hashes * 1e3 / elapsed, hashes * 1e3 / elapsed / cores);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    bool check = false;
+    uint64_t min_ns = 500ULL * 1000000ULL;
+    const char *filter = NULL;
+    int failures = 0;
+
+    for( int i = 1; i < argc; i++ ) {
+        if( 0 == strcmp(argv[i], "--check") ) {
+            check = true;
+        }
+        else if( 0 == strcmp(argv[i], "--time-ms") && i + 1 < argc ) {
+            min_ns = strtoull(argv[++i], NULL, 10) * 1000000ULL;
+        }
+        else {
+            filter = argv[i];
+        }
+    }
+
+    if( sodium_init() < 0 ) {
+        return EXIT_FAILURE;
+    }
+    corpus_init();
+    randombytes_buf(bench_work_root, sizeof(bench_work_root));
+    for( size_t i = 0; i < BENCH_WORK_VALIDATE; i++ ) {
+        sodium_hex2bin(bench_validate_roots[i], sizeof(uint256_t),
+                "718CC2121C3E641059BC1C2CFC45666C99E8AE922F7A807B7D07B62C995D79E2",
+                64, NULL, NULL, NULL);
+        bench_validate_works[i] = 0x2bf29ef00786a6bc;
+    }
+    nl_block_init(&bench_block);
+    for( size_t i = 0; i < BENCH_BLOCKS_INFO; i++ ) {
+        nl_block_init(&bench_blocks[i]);
+    }
+    // The serializers work from the state block
+    if( E_SUCCESS != nanoparse_block(json_state_object, &bench_block) ) {
+        fprintf(stderr, "failed to parse the state block\n");
+        return EXIT_FAILURE;
+    }
+    for( size_t i = 0; i < BENCH_VERIFY; i++ ) {
+        nl_block_init(&bench_verify_blocks[i]);
+        nanoparse_block(json_state_object, &bench_verify_blocks[i]);
+    }
+
+    for( size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++ ) {
+        const bench_case_t *c = &cases[i];
+        if( NULL != filter && NULL == strstr(c->name, filter) ) {
+            continue;
+        }
+        if( check ) {
+            bool ok = (E_SUCCESS == c->run(c->json));
+            printf("%-32s %s\n", c->name, ok ? "ok" : "FAILED");
+            failures += !ok;
+        }
+        else if( !bench_run(c, min_ns) ) {
+            failures++;
+        }
+    }
+
+    if( NULL == filter || NULL != strstr("pow", filter) ) {
+        // --check only needs to see one search succeed
+        failures += !bench_pow(1, check ? 0 : min_ns);
+        if( !check ) {
+            failures += !bench_pow(0, min_ns);
+        }
+    }
+
+    nl_block_free(&bench_block);
+    for( size_t i = 0; i < BENCH_VERIFY; i++ ) {
+        nl_block_free(&bench_verify_blocks[i]);
+    }
+    for( size_t i = 0; i < BENCH_BLOCKS_INFO; i++ ) {
+        nl_block_free(&bench_blocks[i]);
+    }
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,28 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+/* Host stand-in for ESP-IDF's esp_err.h */
+
+#ifndef __HOST_ESP_ERR_H__
+#define __HOST_ESP_ERR_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK   0
+#define ESP_FAIL -1
+
+#define ESP_ERROR_CHECK(x) do { \
+        esp_err_t rc_ = (x); \
+        if( ESP_OK != rc_ ) { \
+            fprintf(stderr, "ESP_ERROR_CHECK failed: %d at %s:%d\n", \
+                    rc_, __FILE__, __LINE__); \
+            abort(); \
+        } \
+    } while(0)
+
+#endif
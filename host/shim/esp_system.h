@@ -0,0 +1,19 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+/* Host stand-in for ESP-IDF's esp_system.h */
+
+#ifndef __HOST_ESP_SYSTEM_H__
+#define __HOST_ESP_SYSTEM_H__
+
+#include <stdint.h>
+#include <sodium.h>
+#include "esp_err.h"
+
+static inline uint32_t esp_random(void) {
+    return randombytes_random();
+}
+
+#endif
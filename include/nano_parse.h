@@ -15,12 +15,71 @@
 #ifndef __INCLUDE_NANO_PARSE_H__
 #define __INCLUDE_NANO_PARSE_H__
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "nano_lib.h"
 #include "jolttypes.h"
 
 /* Saftey Note: It is the user's responsibility that all json_data strings
  * are properly null-terminated */
 
+/* Nano amounts (in raw) always fit in 128 bits */
+typedef struct nanoparse_amount_t {
+    uint64_t hi;
+    uint64_t lo;
+} nanoparse_amount_t;
+
+#define NANOPARSE_AMOUNT_DEC_BUF_LEN 40 // 39 digits + null terminator
+#define NANOPARSE_AMOUNT_HEX_BUF_LEN 33 // 32 hex characters + null terminator
+
+/**
+ * @brief Parse a decimal amount string (not null-terminated).
+ * @return E_SUCCESS on success; E_FAILURE on an invalid character, an empty
+ *         string or a value that doesn't fit in 128 bits.
+ */
+jolt_err_t nanoparse_amount_from_dec(nanoparse_amount_t *amount,
+        const char *str, size_t len);
+
+/**
+ * @brief Parse a hexidecimal amount string (not null-terminated).
+ * @return E_SUCCESS on success; E_FAILURE on an invalid character, an empty
+ *         string or a value that doesn't fit in 128 bits.
+ */
+jolt_err_t nanoparse_amount_from_hex(nanoparse_amount_t *amount,
+        const char *str, size_t len);
+
+/**
+ * @brief Format an amount as a decimal string.
+ * @param[out] buf at least NANOPARSE_AMOUNT_DEC_BUF_LEN to fit any amount
+ * @return E_SUCCESS on success; E_INSUFFICIENT_BUF if buf is too small.
+ */
+jolt_err_t nanoparse_amount_to_dec(char *buf, size_t buf_len,
+        const nanoparse_amount_t *amount);
+
+/**
+ * @brief Format an amount as 32 zero-padded uppercase hex characters.
+ * @return E_SUCCESS on success; E_INSUFFICIENT_BUF if buf is too small.
+ */
+jolt_err_t nanoparse_amount_to_hex(char *buf, size_t buf_len,
+        const nanoparse_amount_t *amount);
+
+/**
+ * @brief Conversions to/from the bignum used by nl_block_t.
+ * nanoparse_amount_from_mpi fails on negative or >128-bit values.
+ */
+jolt_err_t nanoparse_amount_to_mpi(mbedtls_mpi *mpi,
+        const nanoparse_amount_t *amount);
+jolt_err_t nanoparse_amount_from_mpi(nanoparse_amount_t *amount,
+        const mbedtls_mpi *mpi);
+
+/**
+ * @brief Compares two amounts.
+ * @return negative, zero or positive, like memcmp
+ */
+int nanoparse_amount_cmp(const nanoparse_amount_t *a,
+        const nanoparse_amount_t *b);
+
 /**
  * @brief Parse the response from `block_count` rpc command.
  *
@@ -48,6 +107,108 @@ uint32_t nanoparse_block_count(const char *json_data);
  */
 jolt_err_t nanoparse_work( const char *json_data, uint64_t *work);
 
+/* Minimum work value accepted by the network */
+#define NANOPARSE_WORK_THRESHOLD 0xffffffc000000000ULL
+
+#ifndef CONFIG_NANOPARSE_WORK_THREADS
+#define CONFIG_NANOPARSE_WORK_THREADS 0 // One per core
+#endif
+
+/**
+ * @brief Value of a work nonce for a root (the previous block's hash, or
+ * the account's public key for an open block): the Blake2b 8-byte digest
+ * of the little-endian nonce followed by the root. Work is valid if this
+ * is at least the threshold.
+ */
+uint64_t nanoparse_work_value(const uint256_t root, uint64_t work);
+
+typedef struct nanoparse_work_opts_t {
+    uint64_t threshold;          // 0 for NANOPARSE_WORK_THRESHOLD
+    uint8_t n_threads;           // 0 for CONFIG_NANOPARSE_WORK_THREADS
+    const volatile bool *cancel; // Optional; set to true to give up
+} nanoparse_work_opts_t;
+
+/**
+ * @brief Searches for work locally on every core.
+ *
+ * The calling thread takes part in the search; the others are pthreads
+ * that have exited by the time this returns.
+ * @param[in] opts may be NULL for the defaults
+ * @param[out] work valid nonce
+ * @param[out] hashes nonces tried across all threads; may be NULL
+ * @return E_SUCCESS if work was found; E_FAILURE if cancelled
+ */
+jolt_err_t nanoparse_work_generate(const uint256_t root,
+        const nanoparse_work_opts_t *opts, uint64_t *work, uint64_t *hashes);
+
+/**
+ * @brief Same shape as nanoparse_web_work, but generated locally.
+ */
+jolt_err_t nanoparse_work_local(const hex256_t hash, uint64_t *work);
+
+/**
+ * @brief Checks n (root, work) pairs against threshold, several per Blake2b
+ * pass.
+ * @param[in] threshold 0 for NANOPARSE_WORK_THRESHOLD
+ * @param[out] valid per pair result; may be NULL
+ * @return E_SUCCESS if every pair meets the threshold
+ */
+jolt_err_t nanoparse_work_validate(const uint256_t *roots,
+        const uint64_t *works, size_t n, uint64_t threshold, bool *valid);
+
+/**
+ * @brief Root a block's work is computed over: previous, or account for
+ * the first block of an account chain.
+ */
+void nanoparse_block_root(const nl_block_t *block, uint256_t root);
+
+/**
+ * @brief nanoparse_work_validate over the roots and work of parsed blocks.
+ * With CONFIG_NANOPARSE_VALIDATE_WORK, nanoparse_block and
+ * nanoparse_blocks_info call this on everything they return.
+ */
+jolt_err_t nanoparse_blocks_work_validate(const nl_block_t *blocks, size_t n,
+        uint64_t threshold, bool *valid);
+
+#ifndef CONFIG_NANOPARSE_VERIFY_THREADS
+#define CONFIG_NANOPARSE_VERIFY_THREADS 0 // One per core
+#endif
+
+#ifndef CONFIG_NANOPARSE_VERIFY_BATCH_LEN
+#define CONFIG_NANOPARSE_VERIFY_BATCH_LEN 16
+#endif
+
+/**
+ * @brief Blake2b-256 hash of a block, the message its signature covers.
+ * @return E_FAILURE for an UNDEFINED type or a balance over 128 bits
+ */
+jolt_err_t nanoparse_block_hash(const nl_block_t *block, uint256_t hash);
+
+/**
+ * @brief Checks a block's signature against its account and hash.
+ *
+ * Legacy send, receive and change responses don't carry the account, so
+ * it must be filled in before verifying; nanoparse_blocks_info does this
+ * from "block_account".
+ * @return E_SUCCESS if the signature is valid
+ */
+jolt_err_t nanoparse_block_verify(const nl_block_t *block);
+
+/**
+ * @brief nanoparse_block_verify over many blocks.
+ *
+ * Blocks are split into batches of CONFIG_NANOPARSE_VERIFY_BATCH_LEN, each
+ * checked with one randomized batch equation. A batch that fails is
+ * re-checked block by block to find the bad signatures. Consecutive blocks
+ * from the same account share the public key term, so pass a chain's
+ * history in order.
+ * @param[in] n_threads 0 for CONFIG_NANOPARSE_VERIFY_THREADS
+ * @param[out] valid per block result; may be NULL
+ * @return E_SUCCESS if every signature is valid
+ */
+jolt_err_t nanoparse_blocks_verify(const nl_block_t *blocks, size_t n,
+        uint8_t n_threads, bool *valid);
+
 /**
  * @brief Parse the first account response from `accounts_frontiers` rpc command.
  * e.g.
@@ -62,6 +223,80 @@ jolt_err_t nanoparse_work( const char *json_data, uint64_t *work);
  */
 jolt_err_t nanoparse_account_frontier(const char *json_data, hex256_t frontier_block_hash);
 
+/* Response to `account_info` (requested with "representative": "true") */
+typedef struct nanoparse_account_info_t {
+    uint256_t frontier;
+    uint256_t open_block;
+    uint256_t representative_block;
+    nanoparse_amount_t balance;
+    uint32_t block_count;
+    uint32_t modified_timestamp;  // 0 if not in the response
+    uint256_t representative;     // All zero if not in the response
+} nanoparse_account_info_t;
+
+/**
+ * @brief Parse the response of an `account_info` rpc.
+ * @param[in] json_data JSON data to parse
+ * @param[out] info populated account info
+ * @return E_SUCCESS on success; E_FAILURE if the account isn't opened
+ */
+jolt_err_t nanoparse_account_info(const char *json_data,
+        nanoparse_account_info_t *info);
+
+/**
+ * @brief Prepare the state block that follows an account's head from an
+ * `account_info` response requested with "representative": "true".
+ *
+ * This is everything needed to build a send, receive or change on top of
+ * the frontier without fetching the frontier block itself: previous is
+ * set to the frontier, representative and balance to the account's
+ * current ones, and type to STATE. link, signature and work are zeroed
+ * and block->account is left untouched.
+ * @param[out] block Must be previously initialized.
+ * @return E_SUCCESS on success; E_FAILURE if the account isn't opened or
+ *         the representative is missing
+ */
+jolt_err_t nanoparse_next_block(const char *json_data, nl_block_t *block);
+
+typedef struct nanoparse_account_balance_t {
+    nanoparse_amount_t balance;
+    nanoparse_amount_t pending;
+} nanoparse_account_balance_t;
+
+/**
+ * @brief Parse the response of an `account_balance` rpc.
+ * @param[in] json_data JSON data to parse
+ * @param[out] balance populated balance and pending amounts (raw)
+ * @return E_SUCCESS on success
+ */
+jolt_err_t nanoparse_account_balance(const char *json_data,
+        nanoparse_account_balance_t *balance);
+
+/* One entry of an `accounts_frontiers` response */
+typedef struct nanoparse_frontier_t {
+    uint256_t account;  // Public key
+    uint256_t frontier; // Hash of the account's head block
+} nanoparse_frontier_t;
+
+/**
+ * @brief Parse every account of an `accounts_frontiers` response.
+ *
+ * Entries are written in response order. Accounts the node doesn't know
+ * about are absent from the response, so match results by public key.
+ * Doesn't allocate.
+ *
+ * @param[in] json_data JSON data to parse
+ * @param[out] frontiers array to populate
+ * @param[in] frontiers_len number of elements in frontiers
+ * @param[out] n_frontiers number of elements populated
+ * @return E_SUCCESS on success; E_INSUFFICIENT_BUF if the response has
+ *         more than frontiers_len entries (the first frontiers_len are
+ *         still populated).
+ */
+jolt_err_t nanoparse_account_frontiers(const char *json_data,
+        nanoparse_frontier_t *frontiers, size_t frontiers_len,
+        size_t *n_frontiers);
+
 /**
  * @brief Parse the response from `block` rpc command.
 
@@ -80,6 +315,9 @@ jolt_err_t nanoparse_account_frontier(const char *json_data, hex256_t frontier_b
  *       \"work\": \"cab7404f0b5449d0\"\n
  *    }\n"
  * }
+ *
+ * The block may also be a JSON object under "contents" or "block", as
+ * returned when the request contains "json_block": "true".
 
  * @param[in] json_data JSON data to parse
  * @param[out] block populated block structure. Must be previously initialized.
@@ -87,6 +325,251 @@ jolt_err_t nanoparse_account_frontier(const char *json_data, hex256_t frontier_b
  */
 jolt_err_t nanoparse_block(const char *json_data, nl_block_t *block);
 
+/* Block fields for nanoparse_block_partial. "type" is always decoded */
+#define NANOPARSE_BLOCK_ACCOUNT        0x01
+#define NANOPARSE_BLOCK_PREVIOUS       0x02
+#define NANOPARSE_BLOCK_REPRESENTATIVE 0x04
+#define NANOPARSE_BLOCK_LINK           0x08 // link, source or destination
+#define NANOPARSE_BLOCK_SIGNATURE      0x10
+#define NANOPARSE_BLOCK_WORK           0x20
+#define NANOPARSE_BLOCK_BALANCE        0x40
+#define NANOPARSE_BLOCK_ALL            0x7F
+#define NANOPARSE_BLOCK_FIELD_N        7
+
+/* Where a field's value sits in the parsed response */
+typedef struct nanoparse_span_t {
+    uint32_t offset;   // From the start of json_data
+    uint32_t len;
+    uint8_t level;     // JSON string escaping depth the value is under
+} nanoparse_span_t;
+
+/* Fields nanoparse_block_partial skipped, for decoding later */
+typedef struct nanoparse_block_lazy_t {
+    const char *json_data;
+    uint8_t pending;   // NANOPARSE_BLOCK_* fields present but not decoded
+    nanoparse_span_t spans[NANOPARSE_BLOCK_FIELD_N]; // By field bit position
+} nanoparse_block_lazy_t;
+
+/**
+ * @brief nanoparse_block that only decodes the requested fields.
+ *
+ * Every field is still located, and the mandatory ones must be present,
+ * but skipped fields aren't validated, and the block's skipped members
+ * are left untouched. Useful when e.g. only previous and balance are
+ * needed. Always uses the single-pass tokenizer, whichever backend
+ * nanoparse_block is built with, and CONFIG_NANOPARSE_VALIDATE_WORK
+ * doesn't apply.
+ * @param[in] fields NANOPARSE_BLOCK_* fields to decode
+ * @param[out] block Must be previously initialized.
+ * @param[out] lazy spans of the skipped fields; may be NULL
+ * @return E_SUCCESS on success
+ */
+jolt_err_t nanoparse_block_partial(const char *json_data, uint8_t fields,
+        nl_block_t *block, nanoparse_block_lazy_t *lazy);
+
+/**
+ * @brief Decodes fields that nanoparse_block_partial skipped.
+ *
+ * json_data must still be intact. Fields that weren't skipped, or are
+ * already decoded, are ignored.
+ * @return E_SUCCESS on success
+ */
+jolt_err_t nanoparse_block_lazy_decode(nanoparse_block_lazy_t *lazy,
+        uint8_t fields, nl_block_t *block);
+
+/**
+ * @brief nanoparse_block that also hashes the decoded fields, as
+ * nanoparse_block_hash does, while they're still at hand.
+ *
+ * Every block type carries what its hash covers, so this works for
+ * legacy responses without "block_account" too.
+ * @param[out] hash Blake2b-256 hash of the block
+ * @return E_SUCCESS on success
+ */
+jolt_err_t nanoparse_block_and_hash(const char *json_data, nl_block_t *block,
+        uint256_t hash);
+
+/**
+ * @brief A block in one fixed-size, pointer-free, cache-line-aligned struct.
+ *
+ * Unlike nl_block_t it can be memcpy'd, sorted, written to flash or
+ * mmap'd as is. The balance is inline and in host byte order, so stored
+ * blocks are only portable between hosts of the same endianness.
+ */
+typedef struct nanoparse_block_compact_t {
+    uint256_t hash;
+    uint256_t account;
+    uint256_t previous;
+    uint256_t representative;
+    uint256_t link;
+    uint512_t signature;
+    nanoparse_amount_t balance;
+    uint64_t work;
+    uint8_t type;            // nl_block_type_t
+    uint8_t reserved[7];     // Zeroed
+} __attribute__((aligned(64))) nanoparse_block_compact_t;
+
+/**
+ * @brief Packs a block.
+ * @param[in] hash hash of block; NULL to compute it
+ * @return E_FAILURE if the balance doesn't fit in 128 bits or the hash
+ * can't be computed
+ */
+jolt_err_t nanoparse_block_to_compact(nanoparse_block_compact_t *compact,
+        const nl_block_t *block, const uint256_t hash);
+
+/**
+ * @brief Unpacks a block.
+ * @param[out] block Must be previously initialized.
+ */
+jolt_err_t nanoparse_block_from_compact(nl_block_t *block,
+        const nanoparse_block_compact_t *compact);
+
+/**
+ * @brief nanoparse_block_and_hash straight into a compact block.
+ */
+jolt_err_t nanoparse_block_compact_parse(const char *json_data,
+        nanoparse_block_compact_t *compact);
+
+/**
+ * @brief nanoparse_block_to_compact over an array, hashing each block.
+ */
+jolt_err_t nanoparse_blocks_to_compact(nanoparse_block_compact_t *compact,
+        const nl_block_t *blocks, size_t n);
+
+/**
+ * @brief Compact blocks as one array per field, for scans that only touch
+ * a few fields (e.g. summing balances or finding a previous).
+ *
+ * Every column lives in a single caller-supplied buffer and starts on a
+ * 64-byte boundary, so the whole batch can be persisted or mapped in one
+ * piece.
+ */
+typedef struct nanoparse_blocks_soa_t {
+    size_t capacity;
+    uint256_t *hash;
+    uint256_t *account;
+    uint256_t *previous;
+    uint256_t *representative;
+    uint256_t *link;
+    uint512_t *signature;
+    nanoparse_amount_t *balance;
+    uint64_t *work;
+    uint8_t *type;
+} nanoparse_blocks_soa_t;
+
+/**
+ * @brief Bytes of buffer nanoparse_blocks_soa_init needs for capacity blocks.
+ */
+size_t nanoparse_blocks_soa_size(size_t capacity);
+
+/**
+ * @brief Lays the columns out over buf.
+ * @param[in] buf 64-byte aligned, nanoparse_blocks_soa_size(capacity) bytes
+ */
+void nanoparse_blocks_soa_init(nanoparse_blocks_soa_t *soa, void *buf,
+        size_t capacity);
+
+/**
+ * @brief Scatters n compact blocks into rows first..first+n-1.
+ * @return E_INSUFFICIENT_BUF if they don't fit
+ */
+jolt_err_t nanoparse_blocks_soa_store(nanoparse_blocks_soa_t *soa, size_t first,
+        const nanoparse_block_compact_t *blocks, size_t n);
+
+/**
+ * @brief Gathers rows first..first+n-1 back into compact blocks.
+ * @return E_INSUFFICIENT_BUF if they're out of range
+ */
+jolt_err_t nanoparse_blocks_soa_load(const nanoparse_blocks_soa_t *soa,
+        size_t first, nanoparse_block_compact_t *blocks, size_t n);
+
+#ifndef CONFIG_NANOPARSE_BLOCK_CACHE_LEN
+#define CONFIG_NANOPARSE_BLOCK_CACHE_LEN 16
+#endif
+#define NANOPARSE_BLOCK_CACHE_BUCKETS (2 * CONFIG_NANOPARSE_BLOCK_CACHE_LEN)
+#define NANOPARSE_BLOCK_CACHE_NIL 0xFFFF
+
+/* Where a cache entry sits in its bucket chain and the LRU order. Kept
+ * apart so that entries are plain compact blocks */
+typedef struct nanoparse_cache_link_t {
+    uint16_t chain;  // Next entry in the same bucket
+    uint16_t newer;  // LRU neighbours
+    uint16_t older;
+} nanoparse_cache_link_t;
+
+/**
+ * @brief Bounded LRU cache of parsed blocks, keyed by block hash.
+ *
+ * Blocks never change once they exist, so a cached block is never stale.
+ * Lookups hash into a fixed bucket array. The whole cache is one flat
+ * struct that only holds indices, so it can live in a memory-mapped
+ * file (or RTC memory, a flash partition, ...) and be picked back up with
+ * nanoparse_block_cache_open after a restart.
+ *
+ * Not thread-safe; lock around it if it is shared.
+ */
+typedef struct nanoparse_block_cache_t {
+    uint32_t magic;
+    uint16_t capacity;
+    uint16_t entry_size;
+    uint16_t count;
+    uint16_t newest;
+    uint16_t oldest;
+    uint32_t hits;
+    uint32_t misses;
+    uint16_t buckets[NANOPARSE_BLOCK_CACHE_BUCKETS];
+    nanoparse_cache_link_t links[CONFIG_NANOPARSE_BLOCK_CACHE_LEN];
+    nanoparse_block_compact_t entries[CONFIG_NANOPARSE_BLOCK_CACHE_LEN];
+} nanoparse_block_cache_t;
+
+/**
+ * @brief Empties the cache and resets its counters.
+ */
+void nanoparse_block_cache_init(nanoparse_block_cache_t *cache);
+
+/**
+ * @brief Adopts a cache restored from persistent memory.
+ *
+ * Keeps the contents if they were written by a build with the same layout
+ * and are consistent; otherwise initializes the cache.
+ * @return true if the previous contents were kept
+ */
+bool nanoparse_block_cache_open(nanoparse_block_cache_t *cache);
+
+/**
+ * @brief Looks up a block and marks it most recently used.
+ * @param[out] block Must be previously initialized.
+ * @return E_SUCCESS on a hit; E_FAILURE on a miss
+ */
+jolt_err_t nanoparse_block_cache_get(nanoparse_block_cache_t *cache,
+        const uint256_t hash, nl_block_t *block);
+
+/**
+ * @brief Inserts a block, evicting the least recently used one if full.
+ * The caller vouches that hash is the hash of block.
+ * @return E_SUCCESS; E_FAILURE if the balance doesn't fit in 128 bits
+ */
+jolt_err_t nanoparse_block_cache_put(nanoparse_block_cache_t *cache,
+        const uint256_t hash, const nl_block_t *block);
+
+/**
+ * @brief Parse every block of a `blocks_info` response.
+ *
+ * Each entry goes through the same field extraction and validation as
+ * nanoparse_block. blocks[i] receives the block whose hash is hashes[i];
+ * every block in blocks must already be initialized with nl_block_init.
+ * Legacy send, receive and change blocks take their account from the
+ * entry's "block_account", so they can be verified.
+ * @param[in] json_data JSON data to parse
+ * @param[in] hashes block hashes that were requested
+ * @param[in] n_hashes number of hashes (and blocks)
+ * @param[out] blocks output blocks, in the same order as hashes
+ * @return E_SUCCESS if every requested block was returned and is valid
+ */
+jolt_err_t nanoparse_blocks_info(const char *json_data,
+        const uint256_t *hashes, size_t n_hashes, nl_block_t *blocks);
+
 /**
  * @brief Parse the response from `accounts_pending` rpc command.
  * e.g.
@@ -104,8 +587,153 @@ jolt_err_t nanoparse_block(const char *json_data, nl_block_t *block);
 jolt_err_t nanoparse_pending_hash( const char *json_data,
         hex256_t pending_block_hash, mbedtls_mpi *amount);
 
+/**
+ * @brief Same as nanoparse_pending_hash, but fills a nanoparse_amount_t
+ * without touching the heap.
+ */
+jolt_err_t nanoparse_pending_hash_amount( const char *json_data,
+        hex256_t pending_block_hash, nanoparse_amount_t *amount);
+
+/**
+ * @brief Called for every pending block of an `accounts_pending` response.
+ *
+ * amount is NULL unless the request had a "threshold" or "source"; source
+ * is NULL unless the request had "source": "true". Returning anything but
+ * E_SUCCESS stops the parse, and that value is returned by the parser.
+ */
+typedef jolt_err_t (*nanoparse_pending_cb_t)(const uint256_t account,
+        const uint256_t block_hash, const nanoparse_amount_t *amount,
+        const uint256_t source, void *ctx);
+
+/**
+ * @brief Parse every pending block of every account of an `accounts_pending`
+ * response, calling cb as each one is decoded.
+ *
+ * Handles all three response shapes: a list of hashes, hashes mapped to
+ * amounts ("threshold") and hashes mapped to objects ("source").
+ * Doesn't allocate.
+ * e.g.
+ * {
+ *   "blocks" : {
+ *     "xrb_1111111111111111111111111111111111111111111111111117353trpda": {
+ *       "142A538F36833D1CC78B94E11C766F75818F8B940771335C6C1B8AB880C5BB1D": {
+ *         "amount": "6000000000000000000000000000000",
+ *         "source": "xrb_3dcfozsmekr1tr9skf1oa5wbgmxt81qepfdnt7zicq5x3hk65fg4fqj58mbr"
+ *       }
+ *     }
+ *   }
+ * }
+ * @param[in] json_data JSON data to parse
+ * @param[in] cb called once per pending block
+ * @param[in] ctx passed through to cb
+ * @return E_SUCCESS on success
+ */
+jolt_err_t nanoparse_accounts_pending(const char *json_data,
+        nanoparse_pending_cb_t cb, void *ctx);
+
+/**
+ * @brief Caller-supplied bump allocator for the cJSON backed parsers.
+ *
+ * While attached to a thread, every cJSON allocation a nanoparse_* call
+ * makes on that thread is carved out of buf, and the whole region is
+ * released in O(1) when the call returns. Nothing from a parse outlives
+ * the call, so the arena can be reused immediately. Attach one arena per
+ * worker thread; arenas must not be shared between threads.
+ *
+ * Treat the fields as private except for the peak counters.
+ */
+typedef struct nanoparse_arena_t {
+    uint8_t *buf;
+    size_t len;
+    size_t used;
+    size_t peak;      // Bytes the most recent call used at its peak
+    size_t max_peak;  // Largest peak since nanoparse_arena_init
+    bool exhausted;   // An allocation of the current call didn't fit
+} nanoparse_arena_t;
+
+/**
+ * @brief Prepares an arena over buf. buf must outlive the arena.
+ */
+void nanoparse_arena_init(nanoparse_arena_t *arena, void *buf, size_t len);
+
+/**
+ * @brief Routes the calling thread's parser allocations to arena.
+ *
+ * Pass NULL to go back to the heap. The first attach installs cJSON hooks
+ * (cJSON_InitHooks) that fall through to malloc/free outside of
+ * nanoparse_* calls, so other cJSON users are unaffected.
+ */
+void nanoparse_arena_attach(nanoparse_arena_t *arena);
+
+#ifndef CONFIG_NANOPARSE_STREAM_BUF_LEN
+#define CONFIG_NANOPARSE_STREAM_BUF_LEN 512
+#endif
+/* Deepest object level whose members are delivered as records */
+#define NANOPARSE_STREAM_MAX_DEPTH 3
+
+typedef struct nanoparse_stream_t nanoparse_stream_t;
+typedef jolt_err_t (*nanoparse_stream_record_cb_t)(nanoparse_stream_t *s,
+        const char *record, size_t len);
+
+/**
+ * @brief Resumable parser state for a response that arrives in chunks.
+ *
+ * The response is scanned as it is fed and split into records: each member
+ * of an object or string of an array at record_depth, or any scalar member
+ * above it, is buffered on its own and parsed as soon as it is complete. Keys of the
+ * enclosing objects are kept in path. Only one record is held at a time.
+ *
+ * Initialize with one of the nanoparse_*_stream_init functions; treat the
+ * fields as private.
+ */
+struct nanoparse_stream_t {
+    jolt_err_t err;      // Sticky; returned by every later feed
+    uint8_t depth;       // Current object/array nesting
+    uint8_t record_depth;
+    uint8_t cap_depth;   // Nesting of the record being buffered
+    uint8_t obj_mask;    // Bit n set if the container at depth n+1 is an object
+    bool in_str;
+    bool esc;
+    bool capturing;
+    bool expect_member;
+    bool seen_colon;
+    bool done;
+    bool found;          // The response had the expected payload
+    size_t len;
+    char path[NANOPARSE_STREAM_MAX_DEPTH - 1][ADDRESS_BUF_LEN];
+    char buf[CONFIG_NANOPARSE_STREAM_BUF_LEN];
+    nanoparse_stream_record_cb_t record_cb;
+    void (*cb)(void);    // Caller's callback, cast back by record_cb
+    void *cb_ctx;
+};
+
+/**
+ * @brief Feed the next chunk of the response. Chunks may split the
+ * response anywhere; complete records are parsed before this returns.
+ * @return E_SUCCESS, E_INSUFFICIENT_BUF if a single record doesn't fit in
+ * the stream buffer, or the first error from parsing or a callback
+ */
+jolt_err_t nanoparse_stream_feed(nanoparse_stream_t *s,
+        const char *chunk, size_t len);
+
+/**
+ * @brief Call once the whole response has been fed.
+ * @return E_SUCCESS if the response was complete and had the expected key
+ */
+jolt_err_t nanoparse_stream_finish(nanoparse_stream_t *s);
+
+/**
+ * @brief Prepares a stream that behaves like nanoparse_accounts_pending,
+ * delivering each pending block to cb as soon as it has been received.
+ */
+void nanoparse_accounts_pending_stream_init(nanoparse_stream_t *s,
+        nanoparse_pending_cb_t cb, void *ctx);
+
 /**
  * @brief Generates a `process` POST command to be sent to a nano_node.
+ *
+ * With CONFIG_NANOPARSE_JSON_BLOCK the block is emitted as a JSON object
+ * alongside "json_block": "true"; otherwise as an escaped JSON string.
  * e.g.
  * {  
  *   "action": "process",  
@@ -123,19 +751,228 @@ jolt_err_t nanoparse_pending_hash( const char *json_data,
  * @param[in] block Block to source data from
  * @param[out] buffer to populate with a JSON string
  * @param[in] length of buf
- * @return E_SUCCESS on success
+ * @return E_SUCCESS on success; E_INSUFFICIENT_BUF (with buf untouched) if
+ * buf is shorter than nanoparse_process_len(block)
  */
 jolt_err_t nanoparse_process(const nl_block_t *block, char *buf, size_t buf_len);
 
+/**
+ * @brief Exact buffer size (including the null terminator) that
+ * nanoparse_process needs for this block.
+ * @param[in] block Block to source data from
+ * @return required length of buf, or 0 if the block can't be serialized
+ */
+size_t nanoparse_process_len(const nl_block_t *block);
+
+/* Receive buffer pool. Buffers come in size classes that double from
+ * NANOPARSE_POOL_MIN_LEN up to CONFIG_NANOPARSE_POOL_MAX_LEN; released
+ * buffers are kept for reuse (CONFIG_NANOPARSE_POOL_CACHED per class). */
+#ifndef CONFIG_NANOPARSE_POOL_MAX_LEN
+#define CONFIG_NANOPARSE_POOL_MAX_LEN 16384
+#endif
+#ifndef CONFIG_NANOPARSE_POOL_CACHED
+#define CONFIG_NANOPARSE_POOL_CACHED 2
+#endif
+#define NANOPARSE_POOL_MIN_LEN 1024
+
+typedef struct nanoparse_buf_t {
+    char *data;
+    size_t len;
+} nanoparse_buf_t;
+
+typedef struct nanoparse_pool_stats_t {
+    size_t in_use;      // Bytes currently handed out
+    size_t high_water;  // Peak of in_use
+    size_t cached;      // Bytes held for reuse
+    size_t largest;     // Largest buffer handed out
+    uint32_t hits;      // Served from a cached buffer
+    uint32_t misses;    // Had to allocate
+    uint32_t grows;     // nanoparse_pool_grow calls that succeeded
+} nanoparse_pool_stats_t;
+
+/**
+ * @brief Takes a buffer of at least min_len bytes from the pool.
+ * @return E_SUCCESS; E_INSUFFICIENT_BUF if min_len is above
+ *         CONFIG_NANOPARSE_POOL_MAX_LEN; E_FAILURE if out of memory
+ */
+jolt_err_t nanoparse_pool_get(nanoparse_buf_t *buf, size_t min_len);
+
+/**
+ * @brief Swaps buf for one of the next size class. The contents are not
+ * kept. On failure buf is left as it was.
+ * @return E_SUCCESS; E_INSUFFICIENT_BUF if buf is already the largest
+ */
+jolt_err_t nanoparse_pool_grow(nanoparse_buf_t *buf);
+
+/**
+ * @brief Returns buf to the pool. Safe to call on a buffer whose data is NULL.
+ */
+void nanoparse_pool_put(nanoparse_buf_t *buf);
+
+void nanoparse_pool_stats(nanoparse_pool_stats_t *stats);
+
+/**
+ * @brief Frees every cached buffer.
+ */
+void nanoparse_pool_trim(void);
+
+#ifndef CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT
+#define CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT 8
+#endif
+
+/**
+ * @brief Non-blocking transport to a node, supplied by the application.
+ *
+ * submit must send (or copy) cmd before returning. poll returns the next
+ * reply that has arrived, tagged with the id it was submitted under;
+ * replies may complete in any order. The reply must stay valid until the
+ * next call to poll. poll may wait briefly (e.g. select() with a timeout)
+ * but shouldn't block indefinitely.
+ */
+typedef struct nanoparse_transport_t {
+    jolt_err_t (*submit)(void *ctx, uint32_t id, const char *cmd);
+    /* E_SUCCESS if a reply was returned; E_FAILURE if none is ready */
+    jolt_err_t (*poll)(void *ctx, uint32_t *id, const char **reply);
+    /* Optional; drops a request that hasn't been sent yet */
+    void (*cancel)(void *ctx, uint32_t id);
+    void *ctx;
+} nanoparse_transport_t;
+
+typedef jolt_err_t (*nanoparse_rpc_parse_t)(const char *json_data, void *out);
+/* res is the parser's result (or the transport's, if submission failed) */
+typedef void (*nanoparse_rpc_cb_t)(jolt_err_t res, void *out, void *ctx);
+
+typedef struct nanoparse_rpc_slot_t {
+    uint32_t id;
+    bool busy;
+    bool check_hash;   // The reply is a block that must hash to hash
+    nanoparse_rpc_parse_t parse;
+    void *out;
+    nanoparse_rpc_cb_t cb;
+    void *cb_ctx;
+    uint256_t hash;
+} nanoparse_rpc_slot_t;
+
+/**
+ * @brief Keeps up to CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT requests
+ * outstanding over one transport. Replies are parsed and handed to their
+ * callbacks from nanoparse_rpc_poll, on the polling thread. Request ids
+ * are unique across every nanoparse_rpc_t, so several can share a
+ * transport as long as each only polls for its own replies.
+ *
+ * Treat the fields as private. Not thread-safe.
+ */
+typedef struct nanoparse_rpc_t {
+    const nanoparse_transport_t *transport;
+    uint8_t in_flight;
+    nanoparse_rpc_slot_t slots[CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT];
+} nanoparse_rpc_t;
+
+void nanoparse_rpc_init(nanoparse_rpc_t *rpc, const nanoparse_transport_t *transport);
+
+/**
+ * @brief Sends cmd; its reply will be parsed into out with parse and then
+ * passed to cb. out must stay valid until cb has run.
+ * @return E_SUCCESS if the request is in flight; E_INSUFFICIENT_BUF if
+ *         every slot is busy (poll and retry); or the transport's error
+ */
+jolt_err_t nanoparse_rpc_submit(nanoparse_rpc_t *rpc, const char *cmd,
+        nanoparse_rpc_parse_t parse, void *out, nanoparse_rpc_cb_t cb, void *ctx);
+
+/**
+ * @brief Delivers every reply that is ready.
+ * @return number of requests completed
+ */
+size_t nanoparse_rpc_poll(nanoparse_rpc_t *rpc);
+
+/**
+ * @brief Frees every slot in flight, e.g. after the connection dropped.
+ * Each callback runs with E_FAILURE; requests the transport hasn't sent
+ * yet are withdrawn, and replies that arrive later are ignored.
+ * @return number of requests cancelled
+ */
+size_t nanoparse_rpc_cancel(nanoparse_rpc_t *rpc);
+
+/**
+ * @brief Polls until nothing is in flight, or cancels whatever is left
+ * once timeout_ms has passed.
+ * @return E_SUCCESS if every reply arrived in time
+ */
+jolt_err_t nanoparse_rpc_wait(nanoparse_rpc_t *rpc, uint32_t timeout_ms);
+
+/* Typed submissions with the same requests and parsing as the
+ * nanoparse_web_* helpers of the same name */
+jolt_err_t nanoparse_rpc_block(nanoparse_rpc_t *rpc, const hex256_t block_hash,
+        nl_block_t *block, nanoparse_rpc_cb_t cb, void *ctx);
+jolt_err_t nanoparse_rpc_account_info(nanoparse_rpc_t *rpc,
+        const char *account_address, nanoparse_account_info_t *info,
+        nanoparse_rpc_cb_t cb, void *ctx);
+jolt_err_t nanoparse_rpc_account_balance(nanoparse_rpc_t *rpc,
+        const char *account_address, nanoparse_account_balance_t *balance,
+        nanoparse_rpc_cb_t cb, void *ctx);
+jolt_err_t nanoparse_rpc_next_block(nanoparse_rpc_t *rpc, nl_block_t *block,
+        nanoparse_rpc_cb_t cb, void *ctx);
+
 #if CONFIG_NANOPARSE_BUILD_W_LWS || CONFIG_NANOPARSE_BUILD_W_REST
 uint32_t nanoparse_web_block_count();
+/* With CONFIG_NANOPARSE_WORK_LOCAL_FALLBACK, generates locally if the node
+ * doesn't return valid work */
 jolt_err_t nanoparse_web_work(const hex256_t hash, uint64_t *work);
+/* Generates locally while the node is asked; the first valid result wins
+ * and the local search is cancelled if the node answers first. If local
+ * work wins, the node request keeps running in the background, and the
+ * next nanoparse_web_* call waits for it to finish. */
+jolt_err_t nanoparse_web_work_race(const hex256_t hash, uint64_t *work);
 jolt_err_t nanoparse_web_account_frontier(const char *account_address, hex256_t frontier_block_hash);
+jolt_err_t nanoparse_web_account_info(const char *account_address,
+        nanoparse_account_info_t *info);
+jolt_err_t nanoparse_web_account_balance(const char *account_address,
+        nanoparse_account_balance_t *balance);
+/* Issues as many `accounts_frontiers` requests as needed for n_accounts;
+ * frontiers must have room for n_accounts entries */
+jolt_err_t nanoparse_web_account_frontiers(const char * const *account_addresses,
+        size_t n_accounts, nanoparse_frontier_t *frontiers, size_t *n_frontiers);
 jolt_err_t nanoparse_web_block(const hex256_t block_hash, nl_block_t *block);
+/* Serve nanoparse_web_block (and so frontier_block) from cache and fill it
+ * from responses; NULL (the default) disables caching */
+void nanoparse_web_set_block_cache(nanoparse_block_cache_t *cache);
+/* Fetches many blocks with as few blocks_info requests as will fit */
+jolt_err_t nanoparse_web_blocks_info(const uint256_t *hashes, size_t n_hashes,
+        nl_block_t *blocks);
 jolt_err_t nanoparse_web_pending_hash( const char *account_address,
         hex256_t pending_block_hash, mbedtls_mpi *amount);
+/* Requests up to "count" pending blocks (with amount and source) for each
+ * account and streams them to cb. Large account lists are split across
+ * several requests; cb sees every chunk in order */
+jolt_err_t nanoparse_web_accounts_pending(const char * const *account_addresses,
+        size_t n_accounts, uint32_t count, nanoparse_pending_cb_t cb, void *ctx);
 jolt_err_t nanoparse_web_frontier_block(nl_block_t *block);
+/* One account_info round trip; see nanoparse_next_block. Prefer this over
+ * nanoparse_web_frontier_block when building a new block */
+jolt_err_t nanoparse_web_next_block(nl_block_t *block);
 jolt_err_t nanoparse_web_process(nl_block_t *block);
+#define NANOPARSE_WEB_QUEUED_CMD_LEN 256
+
+/* network_get_data as a nanoparse_transport_t. Requests are queued by
+ * submit and run one at a time from poll, so nothing overlaps, but code
+ * written against nanoparse_rpc_t works unchanged until the application
+ * provides a pipelining transport. Each nanoparse_rpc_t needs its own;
+ * pass &transport to nanoparse_rpc_init. Treat the other fields as
+ * private. Not thread-safe. */
+typedef struct nanoparse_web_transport_t {
+    nanoparse_transport_t transport;
+    struct {
+        uint32_t id;
+        char cmd[NANOPARSE_WEB_QUEUED_CMD_LEN];
+    } queue[CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT]; // Oldest first from head
+    uint8_t head;
+    uint8_t len;
+    nanoparse_buf_t reply;  // Valid until the next poll
+} nanoparse_web_transport_t;
+
+void nanoparse_web_transport_init(nanoparse_web_transport_t *t);
+/* Releases the last reply buffer and drops anything still queued */
+void nanoparse_web_transport_free(nanoparse_web_transport_t *t);
 #endif
 
 #endif
@@ -6,14 +6,20 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <sodium.h>
-#include "esp_log.h"
 #include "cJSON.h"
 
 #include "nano_lib.h"
 #include "jolttypes.h"
 #include "nano_parse.h"
+#include "nano_parse_json.h"
+#include "nano_parse_arena.h"
+#include "nano_parse_hex.h"
+#include "nano_parse_keys.h"
+#include "nano_parse_log.h"
+#include "nano_parse_schema.h"
 
 #if CONFIG_NANOPARSE_BUILD_W_LWS
 #include "nano_lws.h"
@@ -24,117 +30,640 @@
 static const char TAG[] = "nano_parse";
 
 
-static char* deblank( char* str ) {
-    /* Replaces all spaces from input string */
+/* Simple responses are described by a field table and parsed by the
+ * schema engine; see nano_parse_schema.h */
 
-    int i, j;
-    for (i = 0, j = 0; i<strlen(str); i++,j++) {
-        if (str[i]!=' ' && str[i]!='\t') {
-            str[j]=str[i];
-        }
-        else {
-            j--;
-        }
-    }
-    str[j]=0;
-    return str;
-}
-
-static char* replace(char* str, char* a, char* b) {
-    /* Replaces all occurences of string "a" with string "b" in str */
-    if( strlen(b) > strlen(a) ){
-        return NULL;
-    }
-    int len  = strlen(str);
-    int lena = strlen(a), lenb = strlen(b);
-    for (char* p = str; (p = strstr(p, a)); ++p) {
-        if (lena != lenb) { // shift end as needed
-            memmove(p+lenb, p+lena,
-                    len - (p - str) - lena);
-        }
-        memcpy(p, b, lenb);
-    }
-    return str;
-}
+static const nanoparse_field_t block_count_fields[] = {
+    { "count", NANOPARSE_FIELD_U32, 0, NANOPARSE_FIELD_REQUIRED },
+};
+static const nanoparse_schema_t block_count_schema =
+        NANOPARSE_SCHEMA("nanoparse_block_count", block_count_fields);
 
 uint32_t nanoparse_block_count( const char *json_data ){
     /* Parses rai_node rpc response for action "block count"
      * Returns uint32_t network block count 
      * Returns 0 on error
      * */
-    uint32_t count_int;
-    const cJSON *count = NULL;
-    cJSON *json = cJSON_Parse(json_data);
-    
-    count = cJSON_GetObjectItemCaseSensitive(json, "count");
-    if ( cJSON_IsString(count) && (count->valuestring != NULL) ){
-        count_int = atoi(count->valuestring);
-    }
-    else{
-        ESP_LOGI(TAG, "unable to parse json");
-        count_int = 0;
+    uint32_t count = 0;
+    if( E_SUCCESS != nanoparse_schema_parse(&block_count_schema, json_data, &count) ){
+        return 0;
     }
-    
-    cJSON_Delete(json);
-    return count_int;
+    return count;
 }
 
+static const nanoparse_field_t work_fields[] = {
+    { "work", NANOPARSE_FIELD_WORK, 0, NANOPARSE_FIELD_REQUIRED },
+};
+static const nanoparse_schema_t work_schema =
+        NANOPARSE_SCHEMA("nanoparse_work", work_fields);
+
 jolt_err_t nanoparse_work( const char *json_data, uint64_t *work){
     /* Parses rai_node rpc response for "work_generate"
      * Returns uint64_t work */
+    return nanoparse_schema_parse(&work_schema, json_data, work);
+}
+
+static const nanoparse_field_t account_frontier_fields[] = {
+    { "frontiers/*", NANOPARSE_FIELD_HASH_HEX, 0, NANOPARSE_FIELD_REQUIRED },
+};
+static const nanoparse_schema_t account_frontier_schema =
+        NANOPARSE_SCHEMA("nanoparse_account_frontier", account_frontier_fields);
+
+jolt_err_t nanoparse_account_frontier(const char *json_data, hex256_t frontier_block_hash){
+    /* Returns the hash (33 characters) of the head block of the account */
+    return nanoparse_schema_parse(&account_frontier_schema, json_data,
+            frontier_block_hash);
+}
+
+static const nanoparse_field_t account_info_fields[] = {
+    { "frontier", NANOPARSE_FIELD_HASH,
+            offsetof(nanoparse_account_info_t, frontier), NANOPARSE_FIELD_REQUIRED },
+    { "open_block", NANOPARSE_FIELD_HASH,
+            offsetof(nanoparse_account_info_t, open_block), NANOPARSE_FIELD_REQUIRED },
+    { "representative_block", NANOPARSE_FIELD_HASH,
+            offsetof(nanoparse_account_info_t, representative_block), NANOPARSE_FIELD_REQUIRED },
+    { "balance", NANOPARSE_FIELD_AMOUNT,
+            offsetof(nanoparse_account_info_t, balance), NANOPARSE_FIELD_REQUIRED },
+    { "block_count", NANOPARSE_FIELD_U32,
+            offsetof(nanoparse_account_info_t, block_count), NANOPARSE_FIELD_REQUIRED },
+    { "modified_timestamp", NANOPARSE_FIELD_U32,
+            offsetof(nanoparse_account_info_t, modified_timestamp), 0 },
+    { "representative", NANOPARSE_FIELD_ADDRESS,
+            offsetof(nanoparse_account_info_t, representative), 0 },
+};
+static const nanoparse_schema_t account_info_schema =
+        NANOPARSE_SCHEMA("nanoparse_account_info", account_info_fields);
+
+jolt_err_t nanoparse_account_info(const char *json_data,
+        nanoparse_account_info_t *info){
+    memset(info, 0, sizeof(nanoparse_account_info_t));
+    return nanoparse_schema_parse(&account_info_schema, json_data, info);
+}
+
+jolt_err_t nanoparse_next_block(const char *json_data, nl_block_t *block){
+    /* Everything a new state block needs from the account's head */
+    nanoparse_account_info_t info;
+    static const uint256_t zero = { 0 };
+    jolt_err_t res;
+
+    res = nanoparse_account_info(json_data, &info);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+    if( 0 == memcmp(info.representative, zero, sizeof(zero)) ){
+        // Requested without "representative": "true"
+        return E_FAILURE;
+    }
+    res = nanoparse_amount_to_mpi(&block->balance, &info.balance);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+
+    block->type = STATE;
+    memcpy(block->previous, info.frontier, sizeof(block->previous));
+    memcpy(block->representative, info.representative, sizeof(block->representative));
+    sodium_memzero(block->link, sizeof(block->link));
+    sodium_memzero(block->signature, sizeof(block->signature));
+    block->work = 0;
+    return E_SUCCESS;
+}
+
+static const nanoparse_field_t account_balance_fields[] = {
+    { "balance", NANOPARSE_FIELD_AMOUNT,
+            offsetof(nanoparse_account_balance_t, balance), NANOPARSE_FIELD_REQUIRED },
+    { "pending", NANOPARSE_FIELD_AMOUNT,
+            offsetof(nanoparse_account_balance_t, pending), NANOPARSE_FIELD_REQUIRED },
+};
+static const nanoparse_schema_t account_balance_schema =
+        NANOPARSE_SCHEMA("nanoparse_account_balance", account_balance_fields);
+
+jolt_err_t nanoparse_account_balance(const char *json_data,
+        nanoparse_account_balance_t *balance){
+    return nanoparse_schema_parse(&account_balance_schema, json_data, balance);
+}
+
+typedef struct frontiers_ctx_t {
+    nanoparse_frontier_t *frontiers;
+    size_t frontiers_len;
+    size_t n;
+    bool found;
+} frontiers_ctx_t;
+
+static jolt_err_t frontier_member_cb(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value,
+        void *ctx){
+    frontiers_ctx_t *f = ctx;
+    nanoparse_frontier_t *entry;
+    char address[ADDRESS_BUF_LEN];
+
+    if( f->n >= f->frontiers_len ) {
+        return E_INSUFFICIENT_BUF;
+    }
+    entry = &f->frontiers[f->n];
+
+    if( NANOPARSE_JSON_STRING != value->type
+            || E_SUCCESS != nanoparse_json_tok_str(key, address, sizeof(address))
+            || E_SUCCESS != nl_address_to_public(entry->account, address)
+            || E_SUCCESS != nanoparse_hex_decode(entry->frontier,
+                    sizeof(entry->frontier), value->start, value->len) ) {
+        NANOPARSE_LOGI(FRONTIERS, "nanoparse_account_frontiers: bad entry");
+        return E_FAILURE;
+    }
+    f->n++;
+    return E_SUCCESS;
+}
+
+static jolt_err_t frontiers_cb(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value,
+        void *ctx){
+    if( !nanoparse_json_tok_eq(key, "frontiers") ) {
+        return E_SUCCESS;
+    }
+    ((frontiers_ctx_t *)ctx)->found = true;
+    if( NANOPARSE_JSON_STRING == value->type ) {
+        // The node returns an empty string when no account has a frontier
+        return E_SUCCESS;
+    }
+    return nanoparse_json_object(lex, value, frontier_member_cb, ctx);
+}
+
+jolt_err_t nanoparse_account_frontiers(const char *json_data,
+        nanoparse_frontier_t *frontiers, size_t frontiers_len,
+        size_t *n_frontiers){
+    /* Parses every entry of an "accounts_frontiers" response in a single
+     * pass without touching the heap */
     jolt_err_t outcome;
-    const cJSON *json_work = NULL;
-    cJSON *json = cJSON_Parse(json_data);
-    
-    json_work = cJSON_GetObjectItemCaseSensitive(json, "work");
-    if (cJSON_IsString(json_work) && (json_work->valuestring != NULL)){
-        outcome = nl_parse_server_work_string(json_work->valuestring, work);
-        if( E_SUCCESS != outcome ){
-            goto exit;
+    frontiers_ctx_t ctx = {
+        .frontiers = frontiers,
+        .frontiers_len = frontiers_len,
+        .n = 0,
+        .found = false,
+    };
+    nanoparse_json_t lex;
+    nanoparse_json_tok_t tok;
+
+    nanoparse_json_init(&lex, json_data, strlen(json_data));
+    nanoparse_json_next(&lex, &tok);
+    outcome = nanoparse_json_object(&lex, &tok, frontiers_cb, &ctx);
+    *n_frontiers = ctx.n;
+    if( E_SUCCESS == outcome && !ctx.found ) {
+        NANOPARSE_LOGI(FRONTIERS, "nanoparse_account_frontiers: no \"frontiers\" key");
+        outcome = E_FAILURE;
+    }
+    return outcome;
+}
+
+/* With CONFIG_NANOPARSE_VALIDATE_WORK, rejects blocks whose work is below the
+ * network threshold. A blocks_info batch is checked in one sweep */
+static jolt_err_t blocks_check_work(const nl_block_t *blocks, size_t n){
+#if CONFIG_NANOPARSE_VALIDATE_WORK
+    if( E_SUCCESS != nanoparse_blocks_work_validate(blocks, n, 0, NULL) ) {
+        NANOPARSE_LOGI(BLOCK, "Block work below threshold");
+        return E_FAILURE;
+    }
+#endif
+    return E_SUCCESS;
+}
+
+/* Legacy send, receive and change blocks don't name their account;
+ * blocks_info gives it alongside as "block_account" */
+static bool block_has_account(nl_block_type_t type){
+    return STATE == type || OPEN == type;
+}
+
+/* Spans of the block fields, recorded in a single pass over the response
+ * and decoded once the whole object has been seen. Keys may come in any
+ * order, but the meaning of "link" and "balance" depends on "type". */
+typedef struct block_fields_t {
+    nanoparse_json_tok_t tok[NANOPARSE_KEY_CONTENTS]; // Indexed by nanoparse_key_t
+    bool nested;       // The block was found; top-level fields are ignored
+    bool in_contents;  // Currently walking the "contents"/"block" object
+} block_fields_t;
+
+#define FIELD(f, name) (&(f)->tok[NANOPARSE_KEY_##name])
+
+static size_t tok_name(const nanoparse_json_tok_t *tok,
+        char buf[NANOPARSE_KEY_MAX_LEN + 1], const char **name){
+    /* Points name at the decoded string; only escaped tokens are copied.
+     * Returns 0 if the token can't be one of the known names */
+    if( NULL == memchr(tok->start, '\\', tok->len) ) {
+        *name = tok->start;
+        return tok->len;
+    }
+    if( E_SUCCESS != nanoparse_json_tok_str(tok, buf, NANOPARSE_KEY_MAX_LEN + 1) ) {
+        return 0;
+    }
+    *name = buf;
+    return strlen(buf);
+}
+
+static nanoparse_key_t tok_key(const nanoparse_json_tok_t *tok){
+    char buf[NANOPARSE_KEY_MAX_LEN + 1];
+    const char *name;
+    size_t len = tok_name(tok, buf, &name);
+    return nanoparse_key_lookup(name, len);
+}
+
+static jolt_err_t block_member_cb(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value,
+        void *ctx){
+    block_fields_t *f = ctx;
+    nanoparse_json_tok_t *dst;
+    nanoparse_key_t k;
+
+    if( f->nested && !f->in_contents ) {
+        return E_SUCCESS;
+    }
+
+    k = tok_key(key);
+    if( !f->in_contents && ( NANOPARSE_KEY_CONTENTS == k
+                || NANOPARSE_KEY_BLOCK == k ) ) {
+        /* The block is either a JSON object ("json_block": "true") or,
+         * for legacy rpc responses, a JSON string that is tokenized in
+         * place, unescaping on the fly */
+        jolt_err_t res;
+        nanoparse_json_t nested;
+        nanoparse_json_tok_t open;
+
+        memset(f, 0, offsetof(block_fields_t, nested));
+        f->nested = true;
+        f->in_contents = true;
+
+        if( NANOPARSE_JSON_OBJECT == value->type ) {
+            res = nanoparse_json_object(lex, value, block_member_cb, f);
         }
-        outcome = E_SUCCESS;
+        else if( E_SUCCESS == nanoparse_json_init_nested(&nested, value) ) {
+            nanoparse_json_next(&nested, &open);
+            res = nanoparse_json_object(&nested, &open, block_member_cb, f);
+        }
+        else {
+            res = E_FAILURE;
+        }
+        f->in_contents = false;
+        return res;
     }
-    else{
-        ESP_LOGE(TAG, "Work Parse Failure.");
-        outcome = E_FAILURE;
-        goto exit;
+
+    if( NANOPARSE_JSON_STRING != value->type || k >= NANOPARSE_KEY_CONTENTS ) {
+        return E_SUCCESS;
     }
 
-    exit:
-        cJSON_Delete(json);
-        return outcome;
+    // First occurence wins, same as cJSON_GetObjectItemCaseSensitive
+    dst = &f->tok[k];
+    if( NULL == dst->start ) {
+        *dst = *value;
+    }
+    return E_SUCCESS;
 }
 
-jolt_err_t nanoparse_account_frontier(const char *json_data, hex256_t frontier_block_hash){
-    /* Returns the hash (33 characters) of the head block of the account */
-    const cJSON *frontiers = NULL;
-    const cJSON *account = NULL;
+static bool tok_present(const nanoparse_json_tok_t *tok){
+    return NULL != tok->start;
+}
+
+static const char *block_key_name(nanoparse_key_t k){
+    switch( k ) {
+        case NANOPARSE_KEY_ACCOUNT:        return "account";
+        case NANOPARSE_KEY_PREVIOUS:       return "previous";
+        case NANOPARSE_KEY_REPRESENTATIVE: return "representative";
+        case NANOPARSE_KEY_SIGNATURE:      return "signature";
+        case NANOPARSE_KEY_DESTINATION:    return "destination";
+        case NANOPARSE_KEY_WORK:           return "work";
+        case NANOPARSE_KEY_BALANCE:        return "balance";
+        default:                           return "link";
+    }
+}
+
+/* Key holding a field, given the block type; NANOPARSE_KEY_UNKNOWN if the
+ * type has no such field */
+static nanoparse_key_t block_field_key(nl_block_type_t type, uint8_t field){
+    switch( field ) {
+        case NANOPARSE_BLOCK_ACCOUNT:        return NANOPARSE_KEY_ACCOUNT;
+        case NANOPARSE_BLOCK_PREVIOUS:       return NANOPARSE_KEY_PREVIOUS;
+        case NANOPARSE_BLOCK_REPRESENTATIVE: return NANOPARSE_KEY_REPRESENTATIVE;
+        case NANOPARSE_BLOCK_SIGNATURE:      return NANOPARSE_KEY_SIGNATURE;
+        case NANOPARSE_BLOCK_WORK:           return NANOPARSE_KEY_WORK;
+        case NANOPARSE_BLOCK_BALANCE:        return NANOPARSE_KEY_BALANCE;
+        case NANOPARSE_BLOCK_LINK:
+            switch( type ) {
+                case STATE:   return NANOPARSE_KEY_LINK;
+                case OPEN:
+                case RECEIVE: return NANOPARSE_KEY_SOURCE;
+                case SEND:    return NANOPARSE_KEY_DESTINATION;
+                default:      return NANOPARSE_KEY_UNKNOWN;
+            }
+        default:
+            return NANOPARSE_KEY_UNKNOWN;
+    }
+}
+
+static jolt_err_t block_field_decode(const nanoparse_json_tok_t *tok,
+        nanoparse_key_t k, nl_block_t *block){
+    char str[ADDRESS_BUF_LEN];
+    nanoparse_amount_t balance;
+    uint8_t *pub = NULL;
     jolt_err_t outcome = E_FAILURE;
-    
-    cJSON *json = cJSON_Parse((char *)json_data);
-    frontiers = cJSON_GetObjectItemCaseSensitive(json, "frontiers");
-    
-    cJSON *current_element = NULL;
-    char *current_key = NULL;
-    cJSON_ArrayForEach(current_element, frontiers){
-        current_key = current_element->string;
-        if (current_key != NULL) {
-            account = cJSON_GetObjectItemCaseSensitive(frontiers, current_key);
-            if (cJSON_IsString(account) && (account->valuestring != NULL)){
-                strlcpy(frontier_block_hash, account->valuestring, HEX_256);
-                outcome = E_SUCCESS;
+
+    switch( k ) {
+        case NANOPARSE_KEY_ACCOUNT:        pub = block->account; break;
+        case NANOPARSE_KEY_REPRESENTATIVE: pub = block->representative; break;
+        case NANOPARSE_KEY_DESTINATION:    pub = block->link; break;
+        case NANOPARSE_KEY_PREVIOUS:
+            outcome = nanoparse_hex_decode(block->previous, sizeof(block->previous),
+                    tok->start, tok->len);
+            break;
+        case NANOPARSE_KEY_SIGNATURE:
+            outcome = nanoparse_hex_decode(block->signature, sizeof(block->signature),
+                    tok->start, tok->len);
+            break;
+        case NANOPARSE_KEY_LINK:
+        case NANOPARSE_KEY_SOURCE:
+            outcome = nanoparse_hex_decode(block->link, sizeof(block->link),
+                    tok->start, tok->len);
+            break;
+        case NANOPARSE_KEY_WORK:
+            outcome = nanoparse_hex_decode_work(&(block->work), tok->start, tok->len);
+            break;
+        case NANOPARSE_KEY_BALANCE:
+            // Legacy send blocks carry the balance as 32 hex characters
+            if( block->type == SEND ) {
+                outcome = nanoparse_amount_from_hex(&balance, tok->start, tok->len);
             }
+            else {
+                outcome = nanoparse_amount_from_dec(&balance, tok->start, tok->len);
+            }
+            if( E_SUCCESS == outcome ) {
+                outcome = nanoparse_amount_to_mpi(&(block->balance), &balance);
+            }
+            break;
+        default:
+            break;
+    }
+
+    if( NULL != pub ) {
+        if( E_SUCCESS == nanoparse_json_tok_str(tok, str, sizeof(str)) ) {
+            outcome = nl_address_to_public(pub, str);
         }
-        break;
     }
-    
-    cJSON_Delete(json);
-    return outcome;
+    if( E_SUCCESS != outcome ) {
+        NANOPARSE_LOGE(BLOCK, "Bad \"%s\"", block_key_name(k));
+        // Address errors (e.g. a bad checksum) are passed on as is
+        return NULL != pub ? outcome : E_FAILURE;
+    }
+    return E_SUCCESS;
+}
+
+/* Fields that count towards nanoparse_block_type_t.expected_n_parse */
+#define BLOCK_COUNTED_FIELDS (NANOPARSE_BLOCK_ACCOUNT | NANOPARSE_BLOCK_PREVIOUS \
+        | NANOPARSE_BLOCK_REPRESENTATIVE | NANOPARSE_BLOCK_LINK | NANOPARSE_BLOCK_BALANCE)
+
+static jolt_err_t block_fields_decode(const block_fields_t *f, uint8_t fields,
+        const char *json_data, nl_block_t *block, nanoparse_block_lazy_t *lazy){
+    /* Mirrors the field rules of the cJSON backend exactly. Fields outside
+     * of fields are only checked for presence; their spans go to lazy */
+    uint8_t n_parse = 0, expected_n_parse;
+    jolt_err_t outcome;
+    char str[ADDRESS_BUF_LEN];
+    const char *name;
+    size_t name_len;
+    const nanoparse_block_type_t *type_info;
+
+    /********************
+     * Parse Block Type *
+     ********************/
+    if( !tok_present(FIELD(f, TYPE)) ) {
+        NANOPARSE_LOGI(BLOCK, "nanoparse_block: Unable to find key 'type' ");
+        return E_FAILURE;
+    }
+    name_len = tok_name(FIELD(f, TYPE), str, &name);
+    type_info = nanoparse_block_type_lookup(name, name_len);
+    if( NULL == type_info ) {
+        NANOPARSE_LOGI(BLOCK, "nanoparse_block: 'type' field not recognized ");
+        return E_FAILURE;
+    }
+    block->type = type_info->type;
+    expected_n_parse = type_info->expected_n_parse;
+    n_parse++;
+
+    if( NULL != lazy ) {
+        memset(lazy, 0, sizeof(nanoparse_block_lazy_t));
+        lazy->json_data = json_data;
+    }
+
+    for( uint8_t i = 0; i < NANOPARSE_BLOCK_FIELD_N; i++ ) {
+        uint8_t field = 1 << i;
+        nanoparse_key_t k = block_field_key(block->type, field);
+        const nanoparse_json_tok_t *tok;
+
+        if( NANOPARSE_KEY_UNKNOWN == k || !tok_present(&f->tok[k]) ) {
+            continue;
+        }
+        tok = &f->tok[k];
+        if( field & fields ) {
+            outcome = block_field_decode(tok, k, block);
+            if( E_SUCCESS != outcome ) {
+                return outcome;
+            }
+        }
+        else if( NULL != lazy ) {
+            lazy->spans[i].offset = tok->start - json_data;
+            lazy->spans[i].len = tok->len;
+            lazy->spans[i].level = tok->level;
+            lazy->pending |= field;
+        }
+        if( field & BLOCK_COUNTED_FIELDS ) {
+            n_parse++;
+        }
+    }
+
+    /***********************
+     * Confirm Parse Count *
+     ***********************/
+    if( n_parse != expected_n_parse ) {
+        NANOPARSE_LOGE(BLOCK, "Parsed %d mandatory fields; expected to parse %d",
+                n_parse, expected_n_parse);
+        return E_FAILURE;
+    }
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_block_partial(const char *json_data, uint8_t fields,
+        nl_block_t *block, nanoparse_block_lazy_t *lazy){
+    /* Always the single-pass tokenizer: skipped fields are kept as spans
+     * of json_data, which a cJSON tree can't provide */
+    block_fields_t f = { 0 };
+    nanoparse_json_t lex;
+    nanoparse_json_tok_t tok;
+
+    nanoparse_json_init(&lex, json_data, strlen(json_data));
+    nanoparse_json_next(&lex, &tok);
+    if( E_SUCCESS != nanoparse_json_object(&lex, &tok, block_member_cb, &f) ) {
+        NANOPARSE_LOGI(BLOCK, "nanoparse_block: failed to parse json data.");
+        return E_FAILURE;
+    }
+    return block_fields_decode(&f, fields, json_data, block, lazy);
+}
+
+jolt_err_t nanoparse_block_lazy_decode(nanoparse_block_lazy_t *lazy,
+        uint8_t fields, nl_block_t *block){
+    for( uint8_t i = 0; i < NANOPARSE_BLOCK_FIELD_N; i++ ) {
+        uint8_t field = 1 << i;
+        nanoparse_json_tok_t tok;
+        jolt_err_t outcome;
+
+        if( !(field & fields & lazy->pending) ) {
+            continue;
+        }
+        tok.type = NANOPARSE_JSON_STRING;
+        tok.start = lazy->json_data + lazy->spans[i].offset;
+        tok.len = lazy->spans[i].len;
+        tok.level = lazy->spans[i].level;
+        outcome = block_field_decode(&tok, block_field_key(block->type, field), block);
+        if( E_SUCCESS != outcome ) {
+            return outcome;
+        }
+        lazy->pending &= ~field;
+    }
+    return E_SUCCESS;
+}
+
+#if CONFIG_NANOPARSE_BLOCK_BACKEND_TOKENIZER
+
+typedef struct blocks_info_ctx_t {
+    const uint256_t *hashes;
+    size_t n_hashes;
+    nl_block_t *blocks;
+    size_t n_parsed;
+    bool found;
+} blocks_info_ctx_t;
+
+typedef struct blocks_info_fields_t {
+    block_fields_t block;
+    nanoparse_json_tok_t block_account;
+} blocks_info_fields_t;
+
+static jolt_err_t blocks_info_member_cb(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value,
+        void *ctx){
+    blocks_info_fields_t *f = ctx;
+
+    if( NANOPARSE_JSON_STRING == value->type
+            && NULL == f->block_account.start
+            && nanoparse_json_tok_eq(key, "block_account") ) {
+        f->block_account = *value;
+        return E_SUCCESS;
+    }
+    return block_member_cb(lex, key, value, &f->block);
+}
+
+static jolt_err_t blocks_info_entry_cb(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value,
+        void *ctx){
+    /* "HASH": { "block_account": ..., "contents": ... } */
+    blocks_info_ctx_t *b = ctx;
+    blocks_info_fields_t fields = { 0 };
+    uint256_t hash;
+    jolt_err_t res;
+
+    if( E_SUCCESS != nanoparse_hex_decode(hash, sizeof(hash), key->start, key->len) ) {
+        NANOPARSE_LOGI(BLOCKS_INFO, "nanoparse_blocks_info: bad block hash");
+        return E_FAILURE;
+    }
+    res = nanoparse_json_object(lex, value, blocks_info_member_cb, &fields);
+    if( E_SUCCESS != res ) {
+        return res;
+    }
+    for( size_t i = 0; i < b->n_hashes; i++ ) {
+        nl_block_t *block = &b->blocks[i];
+
+        if( 0 != memcmp(hash, b->hashes[i], sizeof(hash)) ) {
+            continue;
+        }
+        res = block_fields_decode(&fields.block, NANOPARSE_BLOCK_ALL, NULL,
+                block, NULL);
+        if( E_SUCCESS == res && !block_has_account(block->type)
+                && tok_present(&fields.block_account) ) {
+            res = block_field_decode(&fields.block_account, NANOPARSE_KEY_ACCOUNT, block);
+        }
+        if( E_SUCCESS != res ) {
+            return res;
+        }
+        b->n_parsed++;
+    }
+    return E_SUCCESS;
+}
+
+static jolt_err_t blocks_info_cb(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value,
+        void *ctx){
+    blocks_info_ctx_t *b = ctx;
+    if( !nanoparse_json_tok_eq(key, "blocks") ) {
+        return E_SUCCESS;
+    }
+    b->found = true;
+    return nanoparse_json_object(lex, value, blocks_info_entry_cb, b);
+}
+
+jolt_err_t nanoparse_blocks_info(const char *json_data,
+        const uint256_t *hashes, size_t n_hashes, nl_block_t *blocks){
+    /* Same field handling as nanoparse_block, once per returned block */
+    jolt_err_t outcome;
+    blocks_info_ctx_t b = { 0 };
+    nanoparse_json_t lex;
+    nanoparse_json_tok_t tok;
+
+    b.hashes = hashes;
+    b.n_hashes = n_hashes;
+    b.blocks = blocks;
+    nanoparse_json_init(&lex, json_data, strlen(json_data));
+    nanoparse_json_next(&lex, &tok);
+    outcome = nanoparse_json_object(&lex, &tok, blocks_info_cb, &b);
+    if( E_SUCCESS != outcome ) {
+        NANOPARSE_LOGI(BLOCKS_INFO, "nanoparse_blocks_info: failed to parse json data.");
+        return outcome;
+    }
+    if( !b.found || b.n_parsed != n_hashes ) {
+        NANOPARSE_LOGI(BLOCKS_INFO, "nanoparse_blocks_info: got %d of %d blocks",
+                (int) b.n_parsed, (int) n_hashes);
+        return E_FAILURE;
+    }
+    return blocks_check_work(blocks, n_hashes);
 }
 
 jolt_err_t nanoparse_block(const char *json_data, nl_block_t *block){
-    /* Parses rai_node rpc response to "block".
-     * Returns populated block */
+    /* Parses rai_node rpc response to "block" in a single pass without
+     * touching the heap. Returns populated block */
+    jolt_err_t outcome;
+
+    NANOPARSE_LOGV(BLOCK, "Received json_data:\n%s\n", json_data);
+
+    outcome = nanoparse_block_partial(json_data, NANOPARSE_BLOCK_ALL, block, NULL);
+    if( E_SUCCESS != outcome ) {
+        return outcome;
+    }
+    return blocks_check_work(block, 1);
+}
+
+#else
+
+static void block_items_cjson(const cJSON *obj, const cJSON *items[NANOPARSE_KEY_N]){
+    /* Visits every member once, dispatching on the perfect hash of its
+     * name. First occurence wins, same as cJSON_GetObjectItemCaseSensitive */
+    const cJSON *item = NULL;
+    nanoparse_key_t k;
+
+    memset(items, 0, NANOPARSE_KEY_N * sizeof(items[0]));
+    cJSON_ArrayForEach(item, obj){
+        if( NULL == item->string ){
+            continue;
+        }
+        k = nanoparse_key_lookup(item->string, strlen(item->string));
+        if( NANOPARSE_KEY_UNKNOWN != k && NULL == items[k] ){
+            items[k] = item;
+        }
+    }
+}
+
+static jolt_err_t block_from_cjson(const cJSON *json, nl_block_t *block){
+    /* Populates block from a "block" response or a "blocks_info" entry */
     uint8_t n_parse = 0, expected_n_parse;
     jolt_err_t outcome; // return value
     const cJSON *json_contents = NULL;
@@ -147,87 +676,64 @@ jolt_err_t nanoparse_block(const char *json_data, nl_block_t *block){
     const cJSON *json_work = NULL;
     const cJSON *json_signature = NULL;
     cJSON *nested_json = NULL;
-    char *content_string = NULL;
-    
-    ESP_LOGD(TAG, "Received json_data:\n%s\n", json_data);
+    cJSON *nested_root = NULL;
+    const cJSON *items[NANOPARSE_KEY_N];
+    const nanoparse_block_type_t *type_info;
 
-    cJSON *json = cJSON_Parse((char *)json_data);
-    if(!json){
-        outcome = E_FAILURE;
-        ESP_LOGI(TAG, "nanoparse_block: failed to parse json data.");
-        goto exit;
+    block_items_cjson(json, items);
+    json_contents = items[NANOPARSE_KEY_CONTENTS];
+    if( NULL == json_contents ) {
+        json_contents = items[NANOPARSE_KEY_BLOCK];
     }
-
-    json_contents = cJSON_GetObjectItemCaseSensitive(json, "contents");
-    if(json_contents){
-        content_string = cJSON_Print(json_contents);
-        
-        // remove double escaped newlines
-        replace(content_string, "\\n", " ");
-        if( NULL == content_string ) {
+    if( cJSON_IsObject(json_contents) ){
+        // Requested with "json_block": "true"
+        nested_json = (cJSON *)json_contents;
+    }
+    else if(json_contents){
+        // cJSON already unescaped the nested block string
+        if( !cJSON_IsString(json_contents) || NULL == json_contents->valuestring ) {
+            NANOPARSE_LOGI(BLOCK, "nanoparse_block: block is neither an object nor a string.");
             outcome = E_FAILURE;
             goto exit;
         }
-
-        // remove all double escaped slashes
-        for (char* p = content_string; (p = strchr(p, '\\')); ++p) {
-            *p = ' ';
+        nested_root = cJSON_Parse(json_contents->valuestring);
+        if( NULL == nested_root ) {
+            NANOPARSE_LOGI(BLOCK, "nanoparse_block: failed to parse nested block.");
+            outcome = nanoparse_arena_exhausted() ? E_INSUFFICIENT_BUF : E_FAILURE;
+            goto exit;
         }
-        
-        // Remove Whitespace
-        deblank(content_string);
-
-        // Remove starting and end quotes
-        content_string[0] = ' ';
-        content_string[strlen(content_string)-1] = ' ';
-
-        ESP_LOGI(TAG, "nanoparse_block: deblanked:\n %s", content_string);
-        
-        nested_json = cJSON_Parse(content_string);
+        nested_json = nested_root;
     }
     else{
-        nested_json = json;
+        nested_json = (cJSON *)json;
+    }
+    if( nested_json != json ){
+        block_items_cjson(nested_json, items);
     }
 
     /********************
      * Parse Block Type *
      ********************/
-    json_type = cJSON_GetObjectItemCaseSensitive(nested_json, "type");
+    json_type = items[NANOPARSE_KEY_TYPE];
     if (cJSON_IsString(json_type) && (json_type->valuestring != NULL)){
-        ESP_LOGI(TAG, "nanoparse_block: Type: %s", json_type->valuestring);
+        NANOPARSE_LOGV(BLOCK, "nanoparse_block: Type: %s", json_type->valuestring);
 
-        if (strcmp(json_type->valuestring, "state") == 0){
-            block->type = STATE;
-            expected_n_parse = 6;
-        }
-        else if (strcmp(json_type->valuestring, "send") == 0){
-            block->type = SEND;
-            expected_n_parse = 4;
-        }
-        else if (strcmp(json_type->valuestring, "receive") == 0){
-            block->type = RECEIVE;
-            expected_n_parse = 3;
-        }
-        else if (strcmp(json_type->valuestring, "open") == 0){
-            block->type = OPEN;
-            expected_n_parse = 4;
-        }
-        else if (strcmp(json_type->valuestring, "change") == 0){
-            block->type = CHANGE;
-            expected_n_parse = 3;
-        }
-        else{
-            ESP_LOGI(TAG, "nanoparse_block: 'type' field not recognized ");
+        type_info = nanoparse_block_type_lookup(json_type->valuestring,
+                strlen(json_type->valuestring));
+        if( NULL == type_info ){
+            NANOPARSE_LOGI(BLOCK, "nanoparse_block: 'type' field not recognized ");
             outcome = E_FAILURE;
             goto exit;
         }
+        block->type = type_info->type;
+        expected_n_parse = type_info->expected_n_parse;
         
         n_parse++;
-        ESP_LOGD(TAG, "n_parse incremented: %d", n_parse);
-        ESP_LOGI(TAG, "nanoparse_block: block.type: %d", block->type);
+        NANOPARSE_LOGD(BLOCK, "n_parse incremented: %d", n_parse);
+        NANOPARSE_LOGV(BLOCK, "nanoparse_block: block.type: %d", block->type);
     }
     else {
-        ESP_LOGI(TAG, "nanoparse_block: Unable to find key 'type' ");
+        NANOPARSE_LOGI(BLOCK, "nanoparse_block: Unable to find key 'type' ");
         outcome = E_FAILURE;
         goto exit;
     }
@@ -235,55 +741,61 @@ jolt_err_t nanoparse_block(const char *json_data, nl_block_t *block){
     /*****************
      * Parse Account *
      *****************/
-    json_account = cJSON_GetObjectItemCaseSensitive(nested_json, "account");
+    json_account = items[NANOPARSE_KEY_ACCOUNT];
     if (cJSON_IsString(json_account) && (json_account->valuestring != NULL)){
-        ESP_LOGI(TAG, "nanoparse_block: Account: %s", json_account->valuestring);
+        NANOPARSE_LOGV(BLOCK, "nanoparse_block: Account: %s", json_account->valuestring);
         outcome = nl_address_to_public(block->account, json_account->valuestring);
         if( E_SUCCESS != outcome){
-            ESP_LOGE(TAG, "Bad \"account\"");
+            NANOPARSE_LOGE(BLOCK, "Bad \"account\"");
             goto exit;
         }
         n_parse++;
-        ESP_LOGD(TAG, "n_parse incremented: %d", n_parse);
+        NANOPARSE_LOGD(BLOCK, "n_parse incremented: %d", n_parse);
     }
 
     /******************
      * Parse Previous *
      ******************/
-    json_previous = cJSON_GetObjectItemCaseSensitive(nested_json, "previous");
+    json_previous = items[NANOPARSE_KEY_PREVIOUS];
     if (cJSON_IsString(json_previous) && (json_previous->valuestring != NULL)){
-        sodium_hex2bin(block->previous, sizeof(block->previous),
-                       json_previous->valuestring,
-                       HEX_256, NULL, NULL, NULL);
-        ESP_LOGI(TAG, "nanoparse_block: Previous: %s", json_previous->valuestring);
+        NANOPARSE_LOGV(BLOCK, "nanoparse_block: Previous: %s", json_previous->valuestring);
+        outcome = nanoparse_hex_decode(block->previous, sizeof(block->previous),
+                json_previous->valuestring, strlen(json_previous->valuestring));
+        if( E_SUCCESS != outcome){
+            NANOPARSE_LOGE(BLOCK, "Bad \"previous\"");
+            goto exit;
+        }
         n_parse++;
-        ESP_LOGD(TAG, "n_parse incremented: %d", n_parse);
+        NANOPARSE_LOGD(BLOCK, "n_parse incremented: %d", n_parse);
     }
 
     /************************
      * Parse Representative *
      ************************/
-    json_representative = cJSON_GetObjectItemCaseSensitive(nested_json, "representative");
+    json_representative = items[NANOPARSE_KEY_REPRESENTATIVE];
     if (cJSON_IsString(json_representative) && (json_representative->valuestring != NULL)){
-        ESP_LOGI(TAG, "nanoparse_block: Representative: %s", json_representative->valuestring);
+        NANOPARSE_LOGV(BLOCK, "nanoparse_block: Representative: %s", json_representative->valuestring);
         outcome = nl_address_to_public(block->representative, json_representative->valuestring);
         if( E_SUCCESS != outcome){
-            ESP_LOGE(TAG, "Bad \"representative\"");
+            NANOPARSE_LOGE(BLOCK, "Bad \"representative\"");
             goto exit;
         }
         n_parse++;
-        ESP_LOGD(TAG, "n_parse incremented: %d", n_parse);
+        NANOPARSE_LOGD(BLOCK, "n_parse incremented: %d", n_parse);
     }
 
     /*******************
      * Parse Signature *
      *******************/
-    json_signature = cJSON_GetObjectItemCaseSensitive(nested_json, "signature");
+    json_signature = items[NANOPARSE_KEY_SIGNATURE];
     if (cJSON_IsString(json_signature) && (json_signature->valuestring != NULL)){
-        ESP_LOGI(TAG, "nanoparse_block: Signature: %s", json_signature->valuestring);
-        sodium_hex2bin(block->signature, sizeof(block->signature),
-                       json_signature->valuestring,
-                       HEX_512, NULL, NULL, NULL);
+        NANOPARSE_LOGV(BLOCK, "nanoparse_block: Signature: %s", json_signature->valuestring);
+        outcome = nanoparse_hex_decode(block->signature, sizeof(block->signature),
+                json_signature->valuestring, strlen(json_signature->valuestring));
+        if( E_SUCCESS != outcome){
+            NANOPARSE_LOGE(BLOCK, "Bad \"signature\"");
+            goto exit;
+        }
     }
     
     /**************
@@ -295,49 +807,46 @@ jolt_err_t nanoparse_block(const char *json_data, nl_block_t *block){
     // For send: link is destination pub key ("destination")
     // For receive: link is hash of the pairing send block ("source")
     if ( block->type == STATE ){
-        json_link = cJSON_GetObjectItemCaseSensitive(nested_json, "link");
+        json_link = items[NANOPARSE_KEY_LINK];
     }
     else if(block->type == OPEN || block->type == RECEIVE){
-        json_link = cJSON_GetObjectItemCaseSensitive(nested_json, "source");
+        json_link = items[NANOPARSE_KEY_SOURCE];
     }
 
     if ( cJSON_IsString(json_link) && (json_link->valuestring != NULL) ){
-        sodium_hex2bin(block->link, sizeof(block->link),
-                       json_link->valuestring,
-                       HEX_256, NULL, NULL, NULL);
-        ESP_LOGI(TAG, "nanoparse_block: Link: %s", json_link->valuestring);
+        NANOPARSE_LOGV(BLOCK, "nanoparse_block: Link: %s", json_link->valuestring);
+        outcome = nanoparse_hex_decode(block->link, sizeof(block->link),
+                json_link->valuestring, strlen(json_link->valuestring));
+        if( E_SUCCESS != outcome){
+            NANOPARSE_LOGE(BLOCK, "Bad \"link\"");
+            goto exit;
+        }
         n_parse++;
-        ESP_LOGD(TAG, "n_parse incremented: %d", n_parse);
+        NANOPARSE_LOGD(BLOCK, "n_parse incremented: %d", n_parse);
     }
     else if(block->type == SEND ){
-        json_link = cJSON_GetObjectItemCaseSensitive(nested_json, "destination");
+        json_link = items[NANOPARSE_KEY_DESTINATION];
         if ( cJSON_IsString(json_link) && (json_link->valuestring != NULL) ){
             outcome = nl_address_to_public(block->link, json_link->valuestring);
             if( E_SUCCESS != outcome){
-                ESP_LOGE(TAG, "Bad \"destination\"");
+                NANOPARSE_LOGE(BLOCK, "Bad \"destination\"");
                 goto exit;
             }
             n_parse++;
-            ESP_LOGD(TAG, "n_parse incremented: %d", n_parse);
+            NANOPARSE_LOGD(BLOCK, "n_parse incremented: %d", n_parse);
         }
     }
 
     /**************
      * Parse Work *
      **************/
-    json_work = cJSON_GetObjectItemCaseSensitive(nested_json, "work");
+    json_work = items[NANOPARSE_KEY_WORK];
     if (cJSON_IsString(json_work) && (json_work->valuestring != NULL)){
-        ESP_LOGI(TAG, "nanoparse_block: Work: %s", json_work->valuestring);
-        if(strlen(json_work->valuestring) == 16) {
-            outcome = nl_parse_server_work_string(json_work->valuestring, &(block->work));
-            if( E_SUCCESS != outcome){
-                ESP_LOGE(TAG, "Bad \"work\"");
-                goto exit;
-            }
-        }
-        else {
-            ESP_LOGE(TAG, "Bad \"work\"");
-            outcome = E_FAILURE;
+        NANOPARSE_LOGV(BLOCK, "nanoparse_block: Work: %s", json_work->valuestring);
+        outcome = nanoparse_hex_decode_work(&(block->work),
+                json_work->valuestring, strlen(json_work->valuestring));
+        if( E_SUCCESS != outcome){
+            NANOPARSE_LOGE(BLOCK, "Bad \"work\"");
             goto exit;
         }
     }
@@ -345,23 +854,29 @@ jolt_err_t nanoparse_block(const char *json_data, nl_block_t *block){
     /*****************
      * Parse Balance *
      *****************/
-    json_balance = cJSON_GetObjectItemCaseSensitive(nested_json, "balance");
+    json_balance = items[NANOPARSE_KEY_BALANCE];
     if (cJSON_IsString(json_balance) && (json_balance->valuestring != NULL)){
-        ESP_LOGI(TAG, "nanoparse_block: Balance: %s\n", json_balance->valuestring);
+        NANOPARSE_LOGV(BLOCK, "nanoparse_block: Balance: %s\n", json_balance->valuestring);
         
-        mbedtls_mpi current_balance;
-        mbedtls_mpi_init(&current_balance);
-        // todo: error handle mbed_mpi_read_string
+        nanoparse_amount_t balance;
         if (block->type == SEND){
-            mbedtls_mpi_read_string(&current_balance, 16, json_balance->valuestring);
+            outcome = nanoparse_amount_from_hex(&balance, json_balance->valuestring,
+                    strlen(json_balance->valuestring));
         }
         else {
-            mbedtls_mpi_read_string(&current_balance, 10, json_balance->valuestring);
+            outcome = nanoparse_amount_from_dec(&balance, json_balance->valuestring,
+                    strlen(json_balance->valuestring));
+        }
+        if( E_SUCCESS == outcome ){
+            outcome = nanoparse_amount_to_mpi(&(block->balance), &balance);
+        }
+        if( E_SUCCESS != outcome ){
+            NANOPARSE_LOGE(BLOCK, "Bad \"balance\"");
+            outcome = E_FAILURE;
+            goto exit;
         }
-        mbedtls_mpi_copy( &(block->balance), &current_balance);
-        mbedtls_mpi_free( &current_balance );
         n_parse++;
-        ESP_LOGD(TAG, "n_parse incremented: %d", n_parse);
+        NANOPARSE_LOGD(BLOCK, "n_parse incremented: %d", n_parse);
     }
 
     /***********************
@@ -371,130 +886,492 @@ jolt_err_t nanoparse_block(const char *json_data, nl_block_t *block){
         outcome = E_SUCCESS;
     }
     else{
-        ESP_LOGE(TAG, "Parsed %d mandatory fields; expected to parse %d",
+        NANOPARSE_LOGE(BLOCK, "Parsed %d mandatory fields; expected to parse %d",
                 n_parse, expected_n_parse);
         outcome = E_FAILURE;
         goto exit;
     }
 
     exit:
-        if( NULL != content_string ) {
-            free(content_string);
-            cJSON_Delete(nested_json);
+        cJSON_Delete(nested_root);
+        return outcome;
+}
+
+jolt_err_t nanoparse_block(const char *json_data, nl_block_t *block){
+    /* Parses rai_node rpc response to "block".
+     * Returns populated block */
+    jolt_err_t outcome;
+
+    NANOPARSE_LOGV(BLOCK, "Received json_data:\n%s\n", json_data);
+
+    nanoparse_arena_enter();
+    cJSON *json = cJSON_Parse((char *)json_data);
+    if(!json){
+        NANOPARSE_LOGI(BLOCK, "nanoparse_block: failed to parse json data.");
+        outcome = nanoparse_arena_exhausted() ? E_INSUFFICIENT_BUF : E_FAILURE;
+        nanoparse_arena_exit();
+        return outcome;
+    }
+    outcome = block_from_cjson(json, block);
+    cJSON_Delete(json);
+    nanoparse_arena_exit();
+    if( E_SUCCESS != outcome ){
+        return outcome;
+    }
+    return blocks_check_work(block, 1);
+}
+
+jolt_err_t nanoparse_blocks_info(const char *json_data,
+        const uint256_t *hashes, size_t n_hashes, nl_block_t *blocks){
+    /* Same field handling as nanoparse_block, once per returned block */
+    jolt_err_t outcome = E_SUCCESS;
+    const cJSON *json_blocks = NULL;
+    const cJSON *entry = NULL;
+    const cJSON *json_account = NULL;
+    size_t n_parsed = 0;
+    uint256_t hash;
+
+    nanoparse_arena_enter();
+    cJSON *json = cJSON_Parse((char *)json_data);
+    if(!json){
+        NANOPARSE_LOGI(BLOCKS_INFO, "nanoparse_blocks_info: failed to parse json data.");
+        outcome = nanoparse_arena_exhausted() ? E_INSUFFICIENT_BUF : E_FAILURE;
+        nanoparse_arena_exit();
+        return outcome;
+    }
+
+    json_blocks = cJSON_GetObjectItemCaseSensitive(json, "blocks");
+    if( !cJSON_IsObject(json_blocks) ){
+        NANOPARSE_LOGI(BLOCKS_INFO, "nanoparse_blocks_info: Unable to find key 'blocks'");
+        outcome = E_FAILURE;
+        goto exit;
+    }
+
+    cJSON_ArrayForEach(entry, json_blocks){
+        if( NULL == entry->string || E_SUCCESS != nanoparse_hex_decode(
+                    hash, sizeof(hash), entry->string, strlen(entry->string)) ){
+            NANOPARSE_LOGI(BLOCKS_INFO, "nanoparse_blocks_info: bad block hash");
+            outcome = E_FAILURE;
+            goto exit;
+        }
+        for( size_t i = 0; i < n_hashes; i++ ){
+            if( 0 != memcmp(hash, hashes[i], sizeof(hash)) ){
+                continue;
+            }
+            outcome = block_from_cjson(entry, &blocks[i]);
+            json_account = cJSON_GetObjectItemCaseSensitive(entry, "block_account");
+            if( E_SUCCESS == outcome && !block_has_account(blocks[i].type)
+                    && cJSON_IsString(json_account) && NULL != json_account->valuestring ){
+                outcome = nl_address_to_public(blocks[i].account, json_account->valuestring);
+            }
+            if( E_SUCCESS != outcome ){
+                goto exit;
+            }
+            n_parsed++;
         }
+    }
+
+    if( n_parsed != n_hashes ){
+        NANOPARSE_LOGI(BLOCKS_INFO, "nanoparse_blocks_info: got %d of %d blocks",
+                (int) n_parsed, (int) n_hashes);
+        outcome = E_FAILURE;
+        goto exit;
+    }
+    outcome = blocks_check_work(blocks, n_hashes);
+
+    exit:
         cJSON_Delete(json);
+        nanoparse_arena_exit();
         return outcome;
 }
 
+#endif
+
+jolt_err_t nanoparse_block_and_hash(const char *json_data, nl_block_t *block,
+        uint256_t hash){
+    jolt_err_t outcome;
+
+    outcome = nanoparse_block(json_data, block);
+    if( E_SUCCESS != outcome ){
+        return outcome;
+    }
+    return nanoparse_block_hash(block, hash);
+}
 
 jolt_err_t nanoparse_pending_hash( const char *json_data,
         hex256_t pending_block_hash, mbedtls_mpi *amount){
-    jolt_err_t outcome = E_FAILURE;
-    const cJSON *blocks = NULL;
-    const cJSON *account = NULL;
-    
-    cJSON *json = cJSON_Parse(json_data);
-    
-    blocks = cJSON_GetObjectItemCaseSensitive(json, "blocks");
-
-    cJSON *current_element = NULL;
-    char *current_key = NULL;
-    cJSON_ArrayForEach(current_element, blocks){
-        current_key = current_element->string;
-        if (current_key != NULL) {
-            account = cJSON_GetObjectItemCaseSensitive(blocks, current_key);
-            cJSON_ArrayForEach(current_element, account) {
-                current_key = current_element->string;
-                if (current_key != NULL) {
-                    strlcpy(pending_block_hash, current_key, HEX_256);
-                    const cJSON *pending_contents = cJSON_GetObjectItemCaseSensitive(
-                            account, current_key);
-                    const cJSON *amount_obj = cJSON_GetObjectItemCaseSensitive(
-                            pending_contents, "amount");
-                    mbedtls_mpi_read_string(amount, 10, amount_obj->valuestring);
-                    outcome = E_SUCCESS;
-                }
-                break;
-            }
+    jolt_err_t outcome;
+    nanoparse_amount_t pending_amount;
+
+    outcome = nanoparse_pending_hash_amount(json_data, pending_block_hash,
+            &pending_amount);
+    if( E_SUCCESS != outcome ){
+        return outcome;
+    }
+    return nanoparse_amount_to_mpi(amount, &pending_amount);
+}
+
+typedef struct pending_hash_t {
+    hex256_t hash;
+    nanoparse_amount_t amount;
+} pending_hash_t;
+
+static const nanoparse_field_t pending_hash_fields[] = {
+    { "blocks/*/*", NANOPARSE_FIELD_HASH_HEX, offsetof(pending_hash_t, hash),
+            NANOPARSE_FIELD_REQUIRED | NANOPARSE_FIELD_KEY },
+    { "blocks/*/*/amount", NANOPARSE_FIELD_AMOUNT, offsetof(pending_hash_t, amount),
+            NANOPARSE_FIELD_REQUIRED },
+};
+static const nanoparse_schema_t pending_hash_schema =
+        NANOPARSE_SCHEMA("nanoparse_pending_hash", pending_hash_fields);
+
+jolt_err_t nanoparse_pending_hash_amount( const char *json_data,
+        hex256_t pending_block_hash, nanoparse_amount_t *amount){
+    /* First pending block of the first account */
+    jolt_err_t outcome;
+    pending_hash_t pending;
+
+    outcome = nanoparse_schema_parse(&pending_hash_schema, json_data, &pending);
+    if( E_SUCCESS != outcome ){
+        return outcome;
+    }
+    memcpy(pending_block_hash, pending.hash, sizeof(pending.hash));
+    *amount = pending.amount;
+    return E_SUCCESS;
+}
+
+typedef struct pending_ctx_t {
+    nanoparse_pending_cb_t cb;
+    void *cb_ctx;
+    bool found;
+    uint256_t account;
+    uint256_t block_hash;
+    nanoparse_json_tok_t amount;
+    nanoparse_json_tok_t source;
+} pending_ctx_t;
+
+static jolt_err_t pending_emit(pending_ctx_t *p){
+    /* Decodes the spans of the current pending block and hands it over */
+    nanoparse_amount_t amount;
+    uint256_t source;
+    char address[ADDRESS_BUF_LEN];
+
+    if( NULL != p->amount.start && E_SUCCESS != nanoparse_amount_from_dec(
+                &amount, p->amount.start, p->amount.len) ) {
+        NANOPARSE_LOGI(PENDING, "nanoparse_accounts_pending: bad amount");
+        return E_FAILURE;
+    }
+    if( NULL != p->source.start && (
+                E_SUCCESS != nanoparse_json_tok_str(&p->source, address, sizeof(address))
+                || E_SUCCESS != nl_address_to_public(source, address)) ) {
+        NANOPARSE_LOGI(PENDING, "nanoparse_accounts_pending: bad source");
+        return E_FAILURE;
+    }
+    return p->cb(p->account, p->block_hash,
+            NULL != p->amount.start ? &amount : NULL,
+            NULL != p->source.start ? source : NULL,
+            p->cb_ctx);
+}
+
+static jolt_err_t pending_fields_cb(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value,
+        void *ctx){
+    pending_ctx_t *p = ctx;
+    if( NANOPARSE_JSON_STRING != value->type ) {
+        return E_SUCCESS;
+    }
+    if( nanoparse_json_tok_eq(key, "amount") ) {
+        p->amount = *value;
+    }
+    else if( nanoparse_json_tok_eq(key, "source") ) {
+        p->source = *value;
+    }
+    return E_SUCCESS;
+}
+
+static jolt_err_t pending_hash_begin(pending_ctx_t *p,
+        const nanoparse_json_tok_t *hash){
+    p->amount.start = NULL;
+    p->source.start = NULL;
+    if( NANOPARSE_JSON_STRING != hash->type || E_SUCCESS != nanoparse_hex_decode(
+                p->block_hash, sizeof(p->block_hash), hash->start, hash->len) ) {
+        NANOPARSE_LOGI(PENDING, "nanoparse_accounts_pending: bad block hash");
+        return E_FAILURE;
+    }
+    return E_SUCCESS;
+}
+
+static jolt_err_t pending_hash_element_cb(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *value, void *ctx){
+    /* ["HASH", ...] */
+    jolt_err_t res = pending_hash_begin(ctx, value);
+    if( E_SUCCESS != res ) {
+        return res;
+    }
+    return pending_emit(ctx);
+}
+
+static jolt_err_t pending_hash_member_cb(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value,
+        void *ctx){
+    /* {"HASH": "AMOUNT", ...} or {"HASH": {"amount": ..., "source": ...}} */
+    pending_ctx_t *p = ctx;
+    jolt_err_t res = pending_hash_begin(p, key);
+    if( E_SUCCESS != res ) {
+        return res;
+    }
+    if( NANOPARSE_JSON_STRING == value->type ) {
+        p->amount = *value;
+    }
+    else {
+        res = nanoparse_json_object(lex, value, pending_fields_cb, p);
+        if( E_SUCCESS != res ) {
+            return res;
         }
-        break;
     }
-    
-    cJSON_Delete(json);
+    return pending_emit(p);
+}
+
+static jolt_err_t pending_account_cb(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value,
+        void *ctx){
+    pending_ctx_t *p = ctx;
+    char address[ADDRESS_BUF_LEN];
+
+    if( E_SUCCESS != nanoparse_json_tok_str(key, address, sizeof(address))
+            || E_SUCCESS != nl_address_to_public(p->account, address) ) {
+        NANOPARSE_LOGI(PENDING, "nanoparse_accounts_pending: bad account");
+        return E_FAILURE;
+    }
+    switch( value->type ) {
+        case NANOPARSE_JSON_ARRAY:
+            return nanoparse_json_array(lex, value, pending_hash_element_cb, p);
+        case NANOPARSE_JSON_OBJECT:
+            return nanoparse_json_object(lex, value, pending_hash_member_cb, p);
+        case NANOPARSE_JSON_STRING:
+            // Nothing pending for this account
+            return E_SUCCESS;
+        default:
+            return E_FAILURE;
+    }
+}
+
+static jolt_err_t pending_cb(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value,
+        void *ctx){
+    pending_ctx_t *p = ctx;
+    if( !nanoparse_json_tok_eq(key, "blocks") ) {
+        return E_SUCCESS;
+    }
+    p->found = true;
+    if( NANOPARSE_JSON_STRING == value->type ) {
+        // The node returns an empty string when nothing is pending
+        return E_SUCCESS;
+    }
+    return nanoparse_json_object(lex, value, pending_account_cb, p);
+}
+
+jolt_err_t nanoparse_accounts_pending(const char *json_data,
+        nanoparse_pending_cb_t cb, void *ctx){
+    /* Streams every pending block of an "accounts_pending" response to cb
+     * in a single pass without touching the heap */
+    jolt_err_t outcome;
+    pending_ctx_t p = { 0 };
+    nanoparse_json_t lex;
+    nanoparse_json_tok_t tok;
+
+    p.cb = cb;
+    p.cb_ctx = ctx;
+    nanoparse_json_init(&lex, json_data, strlen(json_data));
+    nanoparse_json_next(&lex, &tok);
+    outcome = nanoparse_json_object(&lex, &tok, pending_cb, &p);
+    if( E_SUCCESS == outcome && !p.found ) {
+        NANOPARSE_LOGI(PENDING, "nanoparse_accounts_pending: no \"blocks\" key");
+        outcome = E_FAILURE;
+    }
     return outcome;
 }
 
-jolt_err_t nanoparse_process(const nl_block_t *block, char *buf, size_t buf_len){
+static jolt_err_t pending_record_cb(nanoparse_stream_t *s,
+        const char *record, size_t len){
+    /* Records are {"blocks": ...}, {"ACCOUNT": ...} inside "blocks", or
+     * {"HASH": ...} or ["HASH"] inside an account */
+    jolt_err_t outcome;
+    pending_ctx_t p = { 0 };
+    nanoparse_json_t lex;
+    nanoparse_json_tok_t tok;
+
+    if( s->cap_depth > 1 && 0 != strcmp(s->path[0], "blocks") ) {
+        return E_SUCCESS;
+    }
+    p.cb = (nanoparse_pending_cb_t) s->cb;
+    p.cb_ctx = s->cb_ctx;
+    nanoparse_json_init(&lex, record, len);
+    nanoparse_json_next(&lex, &tok);
+    switch( s->cap_depth ) {
+        case 1:
+            outcome = nanoparse_json_object(&lex, &tok, pending_cb, &p);
+            s->found |= p.found;
+            return outcome;
+        case 2:
+            s->found = true;
+            return nanoparse_json_object(&lex, &tok, pending_account_cb, &p);
+        default:
+            if( E_SUCCESS != nl_address_to_public(p.account, s->path[1]) ) {
+                NANOPARSE_LOGI(PENDING, "nanoparse_accounts_pending: bad account");
+                return E_FAILURE;
+            }
+            if( NANOPARSE_JSON_ARRAY == tok.type ) {
+                return nanoparse_json_array(&lex, &tok, pending_hash_element_cb, &p);
+            }
+            return nanoparse_json_object(&lex, &tok, pending_hash_member_cb, &p);
+    }
+}
+
+void nanoparse_accounts_pending_stream_init(nanoparse_stream_t *s,
+        nanoparse_pending_cb_t cb, void *ctx){
+    /* One record per pending block, so the buffer only has to hold a
+     * single block regardless of how many are returned */
+    memset(s, 0, sizeof(nanoparse_stream_t));
+    s->err = E_SUCCESS;
+    s->record_depth = 3;
+    s->record_cb = pending_record_cb;
+    s->cb = (void (*)(void)) cb;
+    s->cb_ctx = ctx;
+}
+
+/* The command is emitted as fixed literals interleaved with the fields.
+ * Only the addresses and the balance vary in length, so the full length
+ * is known before anything is written. */
+#if CONFIG_NANOPARSE_JSON_BLOCK
+#define PROCESS_Q "\""
+#define PROCESS_HEAD "{\"action\":\"process\",\"json_block\":\"true\",\"block\":{"
+#define PROCESS_TAIL "}}"
+#else
+#define PROCESS_Q "\\\""
+#define PROCESS_HEAD "{\"action\":\"process\",\"block\":\"{"
+#define PROCESS_TAIL "}\"}"
+#endif
+
+#define PROCESS_KEY(key) PROCESS_Q key PROCESS_Q ":" PROCESS_Q
+
+static const char process_lit_account[] = PROCESS_HEAD
+        PROCESS_KEY("type") "state" PROCESS_Q "," PROCESS_KEY("account");
+static const char process_lit_previous[] = PROCESS_Q "," PROCESS_KEY("previous");
+static const char process_lit_representative[] = PROCESS_Q "," PROCESS_KEY("representative");
+static const char process_lit_balance[] = PROCESS_Q "," PROCESS_KEY("balance");
+static const char process_lit_link[] = PROCESS_Q "," PROCESS_KEY("link");
+static const char process_lit_work[] = PROCESS_Q "," PROCESS_KEY("work");
+static const char process_lit_signature[] = PROCESS_Q "," PROCESS_KEY("signature");
+static const char process_lit_tail[] = PROCESS_Q PROCESS_TAIL;
+
+#define LIT_LEN(lit) (sizeof(lit) - 1)
+#define PROCESS_FIXED_LEN ( LIT_LEN(process_lit_account) \
+        + LIT_LEN(process_lit_previous) + LIT_LEN(process_lit_representative) \
+        + LIT_LEN(process_lit_balance) + LIT_LEN(process_lit_link) \
+        + LIT_LEN(process_lit_work) + LIT_LEN(process_lit_signature) \
+        + LIT_LEN(process_lit_tail) \
+        + 2 * sizeof(uint256_t) /* previous */ \
+        + 2 * sizeof(uint256_t) /* link */ \
+        + 2 * sizeof(uint64_t)  /* work */ \
+        + 2 * sizeof(uint512_t) /* signature */ )
+
+/* The variable-length fields, rendered once */
+typedef struct process_fields_t {
+    char account[ADDRESS_BUF_LEN];
+    char representative[ADDRESS_BUF_LEN];
+    char balance[NANOPARSE_AMOUNT_DEC_BUF_LEN];
+    size_t account_len;
+    size_t representative_len;
+    size_t balance_len;
+} process_fields_t;
+
+static size_t process_address(char *address, const uint256_t public_key){
+    /* Returns the length of the lowercase address, 0 on error */
+    size_t len;
+    if( E_SUCCESS != nl_public_to_address(address, ADDRESS_BUF_LEN, public_key) ){
+        return 0;
+    }
+    for( len = 0; '\0' != address[len]; len++ ){
+        if( address[len] >= 'A' && address[len] <= 'Z' ){
+            address[len] += 'a' - 'A';
+        }
+    }
+    return len;
+}
+
+static jolt_err_t process_fields(process_fields_t *f, const nl_block_t *block){
+    nanoparse_amount_t balance;
+
+    f->account_len = process_address(f->account, block->account);
+    f->representative_len = process_address(f->representative, block->representative);
+    if( 0 == f->account_len || 0 == f->representative_len ){
+        NANOPARSE_LOGE(PROCESS, "process_block: bad account or representative");
+        return E_FAILURE;
+    }
+    if( E_SUCCESS != nanoparse_amount_from_mpi(&balance, &(block->balance))
+            || E_SUCCESS != nanoparse_amount_to_dec(f->balance, sizeof(f->balance), &balance) ){
+        NANOPARSE_LOGE(PROCESS, "process_block: balance doesn't fit in 128 bits");
+        return E_FAILURE;
+    }
+    f->balance_len = strlen(f->balance);
+    return E_SUCCESS;
+}
 
-    /* Account Address (convert bin to address) */
-    char account_address[ADDRESS_BUF_LEN];
+static size_t process_fields_len(const process_fields_t *f){
+    return PROCESS_FIXED_LEN + f->account_len + f->representative_len + f->balance_len;
+}
+
+size_t nanoparse_process_len(const nl_block_t *block){
+    process_fields_t f;
+    if( E_SUCCESS != process_fields(&f, block) ){
+        return 0;
+    }
+    return process_fields_len(&f) + 1;
+}
+
+static char *process_put(char *p, const char *str, size_t len){
+    memcpy(p, str, len);
+    return p + len;
+}
+
+jolt_err_t nanoparse_process(const nl_block_t *block, char *buf, size_t buf_len){
+    /* Writes each field straight into buf in a single pass. buf is only
+     * touched once it is known to be large enough, terminator included */
+    process_fields_t f;
     jolt_err_t res;
-    res = nl_public_to_address(account_address, sizeof(account_address),
-            block->account);
-    strlwr(account_address);
-    ESP_LOGI(TAG, "process_block: Address: %s", account_address);
-    
-    /* Previous (convert bin to hex) */
-    hex256_t previous_hex;
-    sodium_bin2hex(previous_hex, sizeof(previous_hex),
-                   block->previous, sizeof(block->previous));
-    ESP_LOGI(TAG, "process_block: Previous: %s", previous_hex);
-    
-    /* Representative (convert bin to address) */
-    char representative_address[ADDRESS_BUF_LEN];
-    res = nl_public_to_address(representative_address,
-            sizeof(representative_address), block->representative);
-    strlwr(representative_address);
-    ESP_LOGI(TAG, "process_block: Representative: %s", representative_address);
-    
-    /* Balance (convert mpi to string) */
-    char balance_buf[66];
-    size_t n;
-    memset(balance_buf, 0, sizeof(balance_buf));
-    mbedtls_mpi_write_string(&(block->balance), 10, balance_buf, sizeof(balance_buf)-1, &n);
-    ESP_LOGI(TAG, "process_block: Balance: %s", balance_buf);
-    
-    /* Link (convert bin to hex) */
-    hex256_t link_hex;
-    sodium_bin2hex(link_hex, sizeof(link_hex),
-                   block->link, sizeof(block->link));
-    strupr(link_hex);
-    ESP_LOGI(TAG, "process_block: Link: %s", link_hex);
-    
-    /* Work (keep as hex; byteswap) */
-    hex64_t work;
-    nl_generate_server_work_string(work, block->work);
-    ESP_LOGI(TAG, "process_block: Work: %s", work);
-    
-    /* Signature (convert bin to hex) */
-    hex512_t signature_hex;
-    sodium_bin2hex(signature_hex, sizeof(signature_hex),
-                   block->signature, sizeof(block->signature));
-    strupr(signature_hex);
-    ESP_LOGI(TAG, "Block->signature: %s", signature_hex);
-   
-    /* Combine into rai_node RPC command */
-    int buf_req_len = snprintf( (char *) buf, buf_len,
-            "{"
-                "\"action\":\"process\","
-                "\"block\":\"{"
-                    "\\\"type\\\":\\\"state\\\","
-                    "\\\"account\\\":\\\"%s\\\","
-                    "\\\"previous\\\":\\\"%s\\\","
-                    "\\\"representative\\\":\\\"%s\\\","
-                    "\\\"balance\\\":\\\"%s\\\","
-                    "\\\"link\\\":\\\"%s\\\","
-                    "\\\"work\\\":\\\"%s\\\","
-                    "\\\"signature\\\":\\\"%s\\\""
-            "}\"}",
-            account_address, previous_hex, representative_address, balance_buf,
-            link_hex, work, signature_hex);
-
-    if(buf_req_len > buf_len){
-        return E_INSUFFICIENT_BUF;
+    char *p = buf;
+
+    res = process_fields(&f, block);
+    if( E_SUCCESS != res ){
+        return res;
     }
-    else{
-        ESP_LOGI(TAG, "\nprocess_block: Block: %s\n", buf);
-        return E_SUCCESS;
+    if( process_fields_len(&f) + 1 > buf_len ){
+        return E_INSUFFICIENT_BUF;
     }
+
+    // The hex encoders null-terminate; the next literal overwrites it
+    p = process_put(p, process_lit_account, LIT_LEN(process_lit_account));
+    p = process_put(p, f.account, f.account_len);
+    p = process_put(p, process_lit_previous, LIT_LEN(process_lit_previous));
+    nanoparse_hex_encode(p, block->previous, sizeof(block->previous), true);
+    p += 2 * sizeof(block->previous);
+    p = process_put(p, process_lit_representative, LIT_LEN(process_lit_representative));
+    p = process_put(p, f.representative, f.representative_len);
+    p = process_put(p, process_lit_balance, LIT_LEN(process_lit_balance));
+    p = process_put(p, f.balance, f.balance_len);
+    p = process_put(p, process_lit_link, LIT_LEN(process_lit_link));
+    nanoparse_hex_encode(p, block->link, sizeof(block->link), true);
+    p += 2 * sizeof(block->link);
+    p = process_put(p, process_lit_work, LIT_LEN(process_lit_work));
+    nanoparse_hex_encode_work(p, block->work);
+    p += 2 * sizeof(block->work);
+    p = process_put(p, process_lit_signature, LIT_LEN(process_lit_signature));
+    nanoparse_hex_encode(p, block->signature, sizeof(block->signature), true);
+    p += 2 * sizeof(block->signature);
+    p = process_put(p, process_lit_tail, LIT_LEN(process_lit_tail));
+    *p = '\0';
+
+    NANOPARSE_LOGV(PROCESS, "\nprocess_block: Block: %s\n", buf);
+    return E_SUCCESS;
 }
@@ -0,0 +1,204 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "mbedtls/bignum.h"
+
+#include "nano_lib.h"
+#include "jolttypes.h"
+#include "nano_parse.h"
+
+/* Arithmetic is done on 32-bit limbs, which is what the ESP32 multiplies
+ * natively; the two 64-bit halves are only the storage format. */
+#define DEC_CHUNK 1000000000UL
+#define DEC_CHUNK_DIGITS 9
+
+static void amount_to_limbs(uint32_t w[4], const nanoparse_amount_t *a) {
+    w[0] = (uint32_t)a->lo;
+    w[1] = (uint32_t)(a->lo >> 32);
+    w[2] = (uint32_t)a->hi;
+    w[3] = (uint32_t)(a->hi >> 32);
+}
+
+static void amount_from_limbs(nanoparse_amount_t *a, const uint32_t w[4]) {
+    a->lo = ((uint64_t)w[1] << 32) | w[0];
+    a->hi = ((uint64_t)w[3] << 32) | w[2];
+}
+
+/* a = a * m + d; returns false on overflow */
+static bool amount_muladd(nanoparse_amount_t *a, uint32_t m, uint32_t d) {
+    uint32_t w[4];
+    uint64_t carry = d;
+
+    amount_to_limbs(w, a);
+    for( uint8_t i = 0; i < 4; i++ ) {
+        uint64_t t = (uint64_t)w[i] * m + carry;
+        w[i] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    amount_from_limbs(a, w);
+    return 0 == carry;
+}
+
+/* a = a / d; returns the remainder */
+static uint32_t amount_divmod(nanoparse_amount_t *a, uint32_t d) {
+    uint32_t w[4];
+    uint64_t rem = 0;
+
+    amount_to_limbs(w, a);
+    for( int8_t i = 3; i >= 0; i-- ) {
+        uint64_t t = (rem << 32) | w[i];
+        w[i] = (uint32_t)(t / d);
+        rem = t % d;
+    }
+    amount_from_limbs(a, w);
+    return (uint32_t)rem;
+}
+
+static bool amount_is_zero(const nanoparse_amount_t *a) {
+    return 0 == a->hi && 0 == a->lo;
+}
+
+jolt_err_t nanoparse_amount_from_dec(nanoparse_amount_t *amount,
+        const char *str, size_t len){
+    nanoparse_amount_t a = { 0 };
+
+    if( 0 == len ) {
+        return E_FAILURE;
+    }
+    while( len > 0 ) {
+        uint8_t n = (len % DEC_CHUNK_DIGITS) ? len % DEC_CHUNK_DIGITS : DEC_CHUNK_DIGITS;
+        uint32_t chunk = 0, scale = 1;
+        for( uint8_t i = 0; i < n; i++ ) {
+            uint8_t d = str[i] - '0';
+            if( d > 9 ) {
+                return E_FAILURE;
+            }
+            chunk = chunk * 10 + d;
+            scale *= 10;
+        }
+        if( !amount_muladd(&a, scale, chunk) ) {
+            return E_FAILURE;
+        }
+        str += n;
+        len -= n;
+    }
+    *amount = a;
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_amount_from_hex(nanoparse_amount_t *amount,
+        const char *str, size_t len){
+    nanoparse_amount_t a = { 0 };
+
+    if( 0 == len ) {
+        return E_FAILURE;
+    }
+    for( ; len > 0; str++, len-- ) {
+        uint8_t c = *str;
+        uint8_t d = c - '0';
+        if( d > 9 ) {
+            d = (c | 0x20) - 'a';
+            if( d > 5 ) {
+                return E_FAILURE;
+            }
+            d += 10;
+        }
+        if( a.hi >> 60 ) {
+            return E_FAILURE;
+        }
+        a.hi = (a.hi << 4) | (a.lo >> 60);
+        a.lo = (a.lo << 4) | d;
+    }
+    *amount = a;
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_amount_to_dec(char *buf, size_t buf_len,
+        const nanoparse_amount_t *amount){
+    char tmp[NANOPARSE_AMOUNT_DEC_BUF_LEN];
+    char *p = &tmp[sizeof(tmp) - 1];
+    nanoparse_amount_t a = *amount;
+    size_t len;
+
+    *p = '\0';
+    do {
+        uint32_t rem = amount_divmod(&a, DEC_CHUNK);
+        for( uint8_t i = 0; i < DEC_CHUNK_DIGITS; i++ ) {
+            *--p = '0' + rem % 10;
+            rem /= 10;
+            if( 0 == rem && amount_is_zero(&a) ) {
+                break;
+            }
+        }
+    } while( !amount_is_zero(&a) );
+
+    len = &tmp[sizeof(tmp) - 1] - p;
+    if( len + 1 > buf_len ) {
+        return E_INSUFFICIENT_BUF;
+    }
+    memcpy(buf, p, len + 1);
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_amount_to_hex(char *buf, size_t buf_len,
+        const nanoparse_amount_t *amount){
+    /* Zero-padded to 32 uppercase characters, as in legacy send blocks */
+    static const char alphabet[] = "0123456789ABCDEF";
+
+    if( buf_len < NANOPARSE_AMOUNT_HEX_BUF_LEN ) {
+        return E_INSUFFICIENT_BUF;
+    }
+    for( uint8_t i = 0; i < 16; i++ ) {
+        buf[i] = alphabet[(amount->hi >> (60 - 4 * i)) & 0x0F];
+        buf[16 + i] = alphabet[(amount->lo >> (60 - 4 * i)) & 0x0F];
+    }
+    buf[32] = '\0';
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_amount_to_mpi(mbedtls_mpi *mpi,
+        const nanoparse_amount_t *amount){
+    uint8_t bin[16];
+
+    for( uint8_t i = 0; i < 8; i++ ) {
+        bin[i] = amount->hi >> (56 - 8 * i);
+        bin[8 + i] = amount->lo >> (56 - 8 * i);
+    }
+    if( 0 != mbedtls_mpi_read_binary(mpi, bin, sizeof(bin)) ) {
+        return E_FAILURE;
+    }
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_amount_from_mpi(nanoparse_amount_t *amount,
+        const mbedtls_mpi *mpi){
+    uint8_t bin[16];
+    nanoparse_amount_t a = { 0 };
+
+    if( mbedtls_mpi_cmp_int(mpi, 0) < 0
+            || 0 != mbedtls_mpi_write_binary(mpi, bin, sizeof(bin)) ) {
+        return E_FAILURE;
+    }
+    for( uint8_t i = 0; i < 8; i++ ) {
+        a.hi = (a.hi << 8) | bin[i];
+        a.lo = (a.lo << 8) | bin[8 + i];
+    }
+    *amount = a;
+    return E_SUCCESS;
+}
+
+int nanoparse_amount_cmp(const nanoparse_amount_t *a,
+        const nanoparse_amount_t *b){
+    if( a->hi != b->hi ) {
+        return a->hi < b->hi ? -1 : 1;
+    }
+    if( a->lo != b->lo ) {
+        return a->lo < b->lo ? -1 : 1;
+    }
+    return 0;
+}
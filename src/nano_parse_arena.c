@@ -0,0 +1,102 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "cJSON.h"
+
+#include "jolttypes.h"
+#include "nano_parse.h"
+#include "nano_parse_arena.h"
+
+/* Worst-case alignment of anything cJSON allocates */
+#define ARENA_ALIGN 8
+
+/* Per thread; FreeRTOS tasks get their own copy on ESP-IDF */
+static __thread nanoparse_arena_t *attached;
+static __thread nanoparse_arena_t *active;
+static bool hooks_installed;
+
+static bool arena_owns(const nanoparse_arena_t *arena, const void *ptr) {
+    return NULL != arena && (const uint8_t *)ptr >= arena->buf
+            && (const uint8_t *)ptr < arena->buf + arena->len;
+}
+
+static void *arena_malloc(size_t size) {
+    nanoparse_arena_t *arena = active;
+    void *ptr;
+
+    if( NULL == arena ) {
+        return malloc(size);
+    }
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if( size > arena->len - arena->used ) {
+        arena->exhausted = true;
+        return NULL;
+    }
+    ptr = arena->buf + arena->used;
+    arena->used += size;
+    if( arena->used > arena->peak ) {
+        arena->peak = arena->used;
+    }
+    return ptr;
+}
+
+static void arena_free(void *ptr) {
+    // Arena memory is released all at once by nanoparse_arena_exit
+    if( !arena_owns(attached, ptr) ) {
+        free(ptr);
+    }
+}
+
+void nanoparse_arena_init(nanoparse_arena_t *arena, void *buf, size_t len) {
+    uintptr_t start = ((uintptr_t)buf + ARENA_ALIGN - 1)
+            & ~(uintptr_t)(ARENA_ALIGN - 1);
+    size_t skip = start - (uintptr_t)buf;
+
+    arena->buf = (uint8_t *)start;
+    arena->len = len > skip ? len - skip : 0;
+    arena->used = 0;
+    arena->peak = 0;
+    arena->max_peak = 0;
+    arena->exhausted = false;
+}
+
+void nanoparse_arena_attach(nanoparse_arena_t *arena) {
+    if( !hooks_installed ) {
+        // Same pointers every time, so a racing first attach is harmless
+        cJSON_Hooks hooks = {
+            .malloc_fn = arena_malloc,
+            .free_fn = arena_free,
+        };
+        cJSON_InitHooks(&hooks);
+        hooks_installed = true;
+    }
+    attached = arena;
+}
+
+void nanoparse_arena_enter(void) {
+    active = attached;
+    if( NULL != active ) {
+        active->used = 0;
+        active->peak = 0;
+        active->exhausted = false;
+    }
+}
+
+void nanoparse_arena_exit(void) {
+    if( NULL != active ) {
+        if( active->peak > active->max_peak ) {
+            active->max_peak = active->peak;
+        }
+        active->used = 0;
+        active = NULL;
+    }
+}
+
+bool nanoparse_arena_exhausted(void) {
+    return NULL != active && active->exhausted;
+}
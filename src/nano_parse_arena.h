@@ -0,0 +1,23 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+/* Private to nano_parse: brackets a public call that allocates through
+ * cJSON. Between enter and exit the calling thread's attached arena (if
+ * any) serves every cJSON allocation; exit records the peak and releases
+ * it all at once. */
+
+#ifndef __NANO_PARSE_ARENA_H__
+#define __NANO_PARSE_ARENA_H__
+
+#include <stdbool.h>
+
+void nanoparse_arena_enter(void);
+void nanoparse_arena_exit(void);
+
+/* True if an allocation since enter didn't fit in the arena; lets a failed
+ * cJSON_Parse be reported as E_INSUFFICIENT_BUF */
+bool nanoparse_arena_exhausted(void);
+
+#endif
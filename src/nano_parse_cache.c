@@ -0,0 +1,176 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nano_lib.h"
+#include "jolttypes.h"
+#include "nano_parse.h"
+
+#define NIL NANOPARSE_BLOCK_CACHE_NIL
+#define CACHE_MAGIC 0x4E504243 // "NPBC"
+
+#if CONFIG_NANOPARSE_BLOCK_CACHE_LEN < 1 || CONFIG_NANOPARSE_BLOCK_CACHE_LEN >= NIL
+#error "CONFIG_NANOPARSE_BLOCK_CACHE_LEN must be between 1 and 65534"
+#endif
+
+/* Block hashes are uniformly distributed, so any 4 bytes will do */
+static uint16_t cache_bucket(const uint256_t hash) {
+    uint32_t h;
+    memcpy(&h, hash, sizeof(h));
+    return h % NANOPARSE_BLOCK_CACHE_BUCKETS;
+}
+
+static uint16_t cache_find(const nanoparse_block_cache_t *cache,
+        const uint256_t hash) {
+    uint16_t i = cache->buckets[cache_bucket(hash)];
+    // Bounded so that a torn persisted cache can't send us in circles
+    for( uint16_t n = 0; n < cache->count && i < cache->count; n++ ) {
+        if( 0 == memcmp(cache->entries[i].hash, hash, sizeof(uint256_t)) ) {
+            return i;
+        }
+        i = cache->links[i].chain;
+    }
+    return NIL;
+}
+
+static void lru_unlink(nanoparse_block_cache_t *cache, uint16_t i) {
+    nanoparse_cache_link_t *e = &cache->links[i];
+    if( NIL != e->newer ) {
+        cache->links[e->newer].older = e->older;
+    }
+    else {
+        cache->newest = e->older;
+    }
+    if( NIL != e->older ) {
+        cache->links[e->older].newer = e->newer;
+    }
+    else {
+        cache->oldest = e->newer;
+    }
+}
+
+static void lru_push(nanoparse_block_cache_t *cache, uint16_t i) {
+    nanoparse_cache_link_t *e = &cache->links[i];
+    e->newer = NIL;
+    e->older = cache->newest;
+    if( NIL != cache->newest ) {
+        cache->links[cache->newest].newer = i;
+    }
+    else {
+        cache->oldest = i;
+    }
+    cache->newest = i;
+}
+
+static void chain_unlink(nanoparse_block_cache_t *cache, uint16_t i) {
+    uint16_t *link = &cache->buckets[cache_bucket(cache->entries[i].hash)];
+    while( *link != i ) {
+        link = &cache->links[*link].chain;
+    }
+    *link = cache->links[i].chain;
+}
+
+void nanoparse_block_cache_init(nanoparse_block_cache_t *cache) {
+    cache->magic = CACHE_MAGIC;
+    cache->capacity = CONFIG_NANOPARSE_BLOCK_CACHE_LEN;
+    cache->entry_size = sizeof(nanoparse_block_compact_t);
+    cache->count = 0;
+    cache->newest = NIL;
+    cache->oldest = NIL;
+    cache->hits = 0;
+    cache->misses = 0;
+    for( uint16_t i = 0; i < NANOPARSE_BLOCK_CACHE_BUCKETS; i++ ) {
+        cache->buckets[i] = NIL;
+    }
+}
+
+bool nanoparse_block_cache_open(nanoparse_block_cache_t *cache) {
+    uint16_t n = 0;
+    uint16_t newer = NIL;
+
+    if( CACHE_MAGIC != cache->magic
+            || CONFIG_NANOPARSE_BLOCK_CACHE_LEN != cache->capacity
+            || sizeof(nanoparse_block_compact_t) != cache->entry_size
+            || cache->count > CONFIG_NANOPARSE_BLOCK_CACHE_LEN ) {
+        goto reset;
+    }
+
+    /* A crash mid-update can leave a persisted cache torn; walk the LRU
+     * list and check every entry is still reachable through its bucket */
+    for( uint16_t i = cache->newest; NIL != i; i = cache->links[i].older ) {
+        if( i >= cache->count || n >= cache->count
+                || newer != cache->links[i].newer
+                || i != cache_find(cache, cache->entries[i].hash) ) {
+            goto reset;
+        }
+        newer = i;
+        n++;
+    }
+    if( n != cache->count || newer != cache->oldest ) {
+        goto reset;
+    }
+    return true;
+
+    reset:
+        nanoparse_block_cache_init(cache);
+        return false;
+}
+
+jolt_err_t nanoparse_block_cache_get(nanoparse_block_cache_t *cache,
+        const uint256_t hash, nl_block_t *block) {
+    uint16_t i;
+
+    i = cache_find(cache, hash);
+    if( NIL == i ) {
+        cache->misses++;
+        return E_FAILURE;
+    }
+    if( E_SUCCESS != nanoparse_block_from_compact(block, &cache->entries[i]) ) {
+        return E_FAILURE;
+    }
+
+    lru_unlink(cache, i);
+    lru_push(cache, i);
+    cache->hits++;
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_block_cache_put(nanoparse_block_cache_t *cache,
+        const uint256_t hash, const nl_block_t *block) {
+    nanoparse_block_compact_t compact;
+    uint16_t i, bucket;
+
+    if( E_SUCCESS != nanoparse_block_to_compact(&compact, block, hash) ) {
+        return E_FAILURE;
+    }
+
+    i = cache_find(cache, hash);
+    if( NIL != i ) {
+        // Blocks are immutable; just refresh its recency
+        lru_unlink(cache, i);
+        lru_push(cache, i);
+        return E_SUCCESS;
+    }
+
+    if( cache->count < CONFIG_NANOPARSE_BLOCK_CACHE_LEN ) {
+        i = cache->count++;
+    }
+    else {
+        i = cache->oldest;
+        lru_unlink(cache, i);
+        chain_unlink(cache, i);
+    }
+
+    cache->entries[i] = compact;
+
+    bucket = cache_bucket(hash);
+    cache->links[i].chain = cache->buckets[bucket];
+    cache->buckets[bucket] = i;
+    lru_push(cache, i);
+    return E_SUCCESS;
+}
@@ -0,0 +1,162 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nano_lib.h"
+#include "jolttypes.h"
+#include "nano_parse.h"
+
+_Static_assert(256 == sizeof(nanoparse_block_compact_t),
+        "nanoparse_block_compact_t should be exactly four cache lines");
+
+/* Each column of a nanoparse_blocks_soa_t starts on its own cache line */
+#define SOA_ALIGN 64
+#define SOA_COLUMN(capacity, field_size) \
+    ((((capacity) * (field_size)) + SOA_ALIGN - 1) & ~(size_t)(SOA_ALIGN - 1))
+
+jolt_err_t nanoparse_block_to_compact(nanoparse_block_compact_t *compact,
+        const nl_block_t *block, const uint256_t hash) {
+    nanoparse_block_compact_t c;
+
+    memset(&c, 0, sizeof(c));
+    if( E_SUCCESS != nanoparse_amount_from_mpi(&c.balance, &block->balance) ) {
+        return E_FAILURE;
+    }
+    if( NULL != hash ) {
+        memcpy(c.hash, hash, sizeof(c.hash));
+    }
+    else if( E_SUCCESS != nanoparse_block_hash(block, c.hash) ) {
+        return E_FAILURE;
+    }
+    memcpy(c.account, block->account, sizeof(c.account));
+    memcpy(c.previous, block->previous, sizeof(c.previous));
+    memcpy(c.representative, block->representative, sizeof(c.representative));
+    memcpy(c.link, block->link, sizeof(c.link));
+    memcpy(c.signature, block->signature, sizeof(c.signature));
+    c.work = block->work;
+    c.type = block->type;
+
+    *compact = c;
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_block_from_compact(nl_block_t *block,
+        const nanoparse_block_compact_t *compact) {
+    if( E_SUCCESS != nanoparse_amount_to_mpi(&block->balance, &compact->balance) ) {
+        return E_FAILURE;
+    }
+    block->type = compact->type;
+    memcpy(block->account, compact->account, sizeof(block->account));
+    memcpy(block->previous, compact->previous, sizeof(block->previous));
+    memcpy(block->representative, compact->representative, sizeof(block->representative));
+    memcpy(block->link, compact->link, sizeof(block->link));
+    memcpy(block->signature, compact->signature, sizeof(block->signature));
+    block->work = compact->work;
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_block_compact_parse(const char *json_data,
+        nanoparse_block_compact_t *compact) {
+    nl_block_t block;
+    uint256_t hash;
+    jolt_err_t res;
+
+    nl_block_init(&block);
+    res = nanoparse_block_and_hash(json_data, &block, hash);
+    if( E_SUCCESS == res ) {
+        res = nanoparse_block_to_compact(compact, &block, hash);
+    }
+    nl_block_free(&block);
+    return res;
+}
+
+jolt_err_t nanoparse_blocks_to_compact(nanoparse_block_compact_t *compact,
+        const nl_block_t *blocks, size_t n) {
+    for( size_t i = 0; i < n; i++ ) {
+        jolt_err_t res = nanoparse_block_to_compact(&compact[i], &blocks[i], NULL);
+        if( E_SUCCESS != res ) {
+            return res;
+        }
+    }
+    return E_SUCCESS;
+}
+
+size_t nanoparse_blocks_soa_size(size_t capacity) {
+    return 5 * SOA_COLUMN(capacity, sizeof(uint256_t))
+            + SOA_COLUMN(capacity, sizeof(uint512_t))
+            + SOA_COLUMN(capacity, sizeof(nanoparse_amount_t))
+            + SOA_COLUMN(capacity, sizeof(uint64_t))
+            + SOA_COLUMN(capacity, sizeof(uint8_t));
+}
+
+void nanoparse_blocks_soa_init(nanoparse_blocks_soa_t *soa, void *buf,
+        size_t capacity) {
+    uint8_t *p = buf;
+
+    soa->capacity = capacity;
+    soa->balance = (nanoparse_amount_t *)p;
+    p += SOA_COLUMN(capacity, sizeof(nanoparse_amount_t));
+    soa->work = (uint64_t *)p;
+    p += SOA_COLUMN(capacity, sizeof(uint64_t));
+    soa->hash = (uint256_t *)p;
+    p += SOA_COLUMN(capacity, sizeof(uint256_t));
+    soa->account = (uint256_t *)p;
+    p += SOA_COLUMN(capacity, sizeof(uint256_t));
+    soa->previous = (uint256_t *)p;
+    p += SOA_COLUMN(capacity, sizeof(uint256_t));
+    soa->representative = (uint256_t *)p;
+    p += SOA_COLUMN(capacity, sizeof(uint256_t));
+    soa->link = (uint256_t *)p;
+    p += SOA_COLUMN(capacity, sizeof(uint256_t));
+    soa->signature = (uint512_t *)p;
+    p += SOA_COLUMN(capacity, sizeof(uint512_t));
+    soa->type = p;
+}
+
+jolt_err_t nanoparse_blocks_soa_store(nanoparse_blocks_soa_t *soa, size_t first,
+        const nanoparse_block_compact_t *blocks, size_t n) {
+    if( first > soa->capacity || n > soa->capacity - first ) {
+        return E_INSUFFICIENT_BUF;
+    }
+    for( size_t i = 0; i < n; i++ ) {
+        const nanoparse_block_compact_t *b = &blocks[i];
+        size_t row = first + i;
+        memcpy(soa->hash[row], b->hash, sizeof(uint256_t));
+        memcpy(soa->account[row], b->account, sizeof(uint256_t));
+        memcpy(soa->previous[row], b->previous, sizeof(uint256_t));
+        memcpy(soa->representative[row], b->representative, sizeof(uint256_t));
+        memcpy(soa->link[row], b->link, sizeof(uint256_t));
+        memcpy(soa->signature[row], b->signature, sizeof(uint512_t));
+        soa->balance[row] = b->balance;
+        soa->work[row] = b->work;
+        soa->type[row] = b->type;
+    }
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_blocks_soa_load(const nanoparse_blocks_soa_t *soa,
+        size_t first, nanoparse_block_compact_t *blocks, size_t n) {
+    if( first > soa->capacity || n > soa->capacity - first ) {
+        return E_INSUFFICIENT_BUF;
+    }
+    for( size_t i = 0; i < n; i++ ) {
+        nanoparse_block_compact_t *b = &blocks[i];
+        size_t row = first + i;
+        memset(b, 0, sizeof(*b));
+        memcpy(b->hash, soa->hash[row], sizeof(uint256_t));
+        memcpy(b->account, soa->account[row], sizeof(uint256_t));
+        memcpy(b->previous, soa->previous[row], sizeof(uint256_t));
+        memcpy(b->representative, soa->representative[row], sizeof(uint256_t));
+        memcpy(b->link, soa->link[row], sizeof(uint256_t));
+        memcpy(b->signature, soa->signature[row], sizeof(uint512_t));
+        b->balance = soa->balance[row];
+        b->work = soa->work[row];
+        b->type = soa->type[row];
+    }
+    return E_SUCCESS;
+}
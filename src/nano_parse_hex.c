@@ -0,0 +1,134 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "jolttypes.h"
+#include "nano_parse_hex.h"
+
+static inline int hex_nibble(uint8_t c) {
+    uint8_t d = c - '0';
+    uint8_t l = (c | 0x20) - 'a';
+    if( d < 10 ) return d;
+    if( l < 6 ) return l + 10;
+    return -1;
+}
+
+static inline char hex_char(uint8_t n, char alpha) {
+    return n < 10 ? '0' + n : alpha + n - 10;
+}
+
+#if defined(__SSE2__)
+/* 16 hex characters -> 8 bytes. Returns false on any non-hex character */
+static inline bool hex_decode_16(uint8_t *bin, const char *hex) {
+    const __m128i v = _mm_loadu_si128((const __m128i *)hex);
+    const __m128i x = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    const __m128i is_digit = _mm_and_si128(
+            _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+            _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    const __m128i is_alpha = _mm_and_si128(
+            _mm_cmpgt_epi8(x, _mm_set1_epi8('a' - 1)),
+            _mm_cmplt_epi8(x, _mm_set1_epi8('f' + 1)));
+    if( 0xFFFF != _mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) ) {
+        return false;
+    }
+
+    __m128i n = _mm_or_si128(
+            _mm_and_si128(is_digit, _mm_sub_epi8(v, _mm_set1_epi8('0'))),
+            _mm_andnot_si128(is_digit, _mm_sub_epi8(x, _mm_set1_epi8('a' - 10))));
+    // Each 16-bit lane holds (high nibble, low nibble) in memory order
+    n = _mm_or_si128(_mm_slli_epi16(n, 4), _mm_srli_epi16(n, 8));
+    n = _mm_and_si128(n, _mm_set1_epi16(0x00FF));
+    _mm_storel_epi64((__m128i *)bin, _mm_packus_epi16(n, n));
+    return true;
+}
+
+/* 8 bytes -> 16 hex characters */
+static inline void hex_encode_8(char *hex, const uint8_t *bin, char alpha) {
+    const __m128i b = _mm_loadl_epi64((const __m128i *)bin);
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(b, 4), mask);
+    const __m128i lo = _mm_and_si128(b, mask);
+    __m128i n = _mm_unpacklo_epi8(hi, lo);
+    __m128i gap = _mm_and_si128(_mm_cmpgt_epi8(n, _mm_set1_epi8(9)),
+            _mm_set1_epi8(alpha - '9' - 1));
+    n = _mm_add_epi8(_mm_add_epi8(n, _mm_set1_epi8('0')), gap);
+    _mm_storeu_si128((__m128i *)hex, n);
+}
+#endif
+
+jolt_err_t nanoparse_hex_decode(uint8_t *bin, size_t bin_len,
+        const char *hex, size_t hex_len){
+    size_t i = 0;
+
+    if( hex_len != 2 * bin_len ) {
+        return E_FAILURE;
+    }
+
+#if defined(__SSE2__)
+    for( ; i + 8 <= bin_len; i += 8 ) {
+        if( !hex_decode_16(&bin[i], &hex[2 * i]) ) {
+            return E_FAILURE;
+        }
+    }
+#endif
+    for( ; i < bin_len; i++ ) {
+        int hi = hex_nibble(hex[2 * i]);
+        int lo = hex_nibble(hex[2 * i + 1]);
+        if( hi < 0 || lo < 0 ) {
+            return E_FAILURE;
+        }
+        bin[i] = (hi << 4) | lo;
+    }
+    return E_SUCCESS;
+}
+
+void nanoparse_hex_encode(char *hex, const uint8_t *bin, size_t bin_len,
+        bool upper){
+    const char alpha = upper ? 'A' : 'a';
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for( ; i + 8 <= bin_len; i += 8 ) {
+        hex_encode_8(&hex[2 * i], &bin[i], alpha);
+    }
+#endif
+    for( ; i < bin_len; i++ ) {
+        hex[2 * i] = hex_char(bin[i] >> 4, alpha);
+        hex[2 * i + 1] = hex_char(bin[i] & 0x0F, alpha);
+    }
+    hex[2 * bin_len] = '\0';
+}
+
+jolt_err_t nanoparse_hex_decode_work(uint64_t *work, const char *hex,
+        size_t hex_len){
+    uint8_t bin[sizeof(uint64_t)];
+    uint64_t w = 0;
+
+    if( E_SUCCESS != nanoparse_hex_decode(bin, sizeof(bin), hex, hex_len) ) {
+        return E_FAILURE;
+    }
+    for( uint8_t i = 0; i < sizeof(bin); i++ ) {
+        w = (w << 8) | bin[i];
+    }
+    *work = w;
+    return E_SUCCESS;
+}
+
+void nanoparse_hex_encode_work(hex64_t hex, uint64_t work){
+    uint8_t bin[sizeof(uint64_t)];
+
+    for( int8_t i = sizeof(bin) - 1; i >= 0; i-- ) {
+        bin[i] = work & 0xFF;
+        work >>= 8;
+    }
+    nanoparse_hex_encode(hex, bin, sizeof(bin), false);
+}
@@ -0,0 +1,32 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+/* Private to nano_parse: hex codec for hashes, links, signatures and work.
+ * Decoding validates and converts in one pass; encoding emits the final
+ * case directly. Uses SSE2 when available, otherwise a scalar loop. */
+
+#ifndef __NANO_PARSE_HEX_H__
+#define __NANO_PARSE_HEX_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "jolttypes.h"
+
+/* Decodes exactly 2*bin_len hex characters of either case.
+ * Returns E_FAILURE on a length mismatch or any non-hex character. */
+jolt_err_t nanoparse_hex_decode(uint8_t *bin, size_t bin_len,
+        const char *hex, size_t hex_len);
+
+/* Writes 2*bin_len hex characters followed by a null terminator */
+void nanoparse_hex_encode(char *hex, const uint8_t *bin, size_t bin_len,
+        bool upper);
+
+/* Work nonces are sent big-endian as 16 hex characters */
+jolt_err_t nanoparse_hex_decode_work(uint64_t *work, const char *hex,
+        size_t hex_len);
+void nanoparse_hex_encode_work(hex64_t hex, uint64_t work);
+
+#endif
@@ -0,0 +1,351 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "jolttypes.h"
+#include "nano_parse_json.h"
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool is_primitive(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')
+            || c == '-' || c == '+' || c == '.' || c == 'E';
+}
+
+static int hex_val(char c) {
+    if( c >= '0' && c <= '9' ) return c - '0';
+    if( c >= 'a' && c <= 'f' ) return c - 'a' + 10;
+    if( c >= 'A' && c <= 'F' ) return c - 'A' + 10;
+    return -1;
+}
+
+static bool string_getc(const char **p, const char *end, uint8_t level, char *c);
+
+/* Reads one character of a document at the given escaping level. A level-N
+ * document is simply the contents of a string in a level-(N-1) document. */
+static bool doc_getc(const char **p, const char *end, uint8_t level, char *c) {
+    if( level > 0 ) {
+        return string_getc(p, end, level - 1, c);
+    }
+    if( *p >= end || '\0' == **p ) {
+        return false;
+    }
+    *c = *(*p)++;
+    return true;
+}
+
+/* Reads one character of string contents, decoding its escapes */
+static bool string_getc(const char **p, const char *end, uint8_t level, char *c) {
+    if( !doc_getc(p, end, level, c) ) {
+        return false;
+    }
+    if( '\\' != *c ) {
+        return true;
+    }
+    if( !doc_getc(p, end, level, c) ) {
+        return false;
+    }
+    switch( *c ) {
+        case 'b': *c = '\b'; break;
+        case 'f': *c = '\f'; break;
+        case 'n': *c = '\n'; break;
+        case 'r': *c = '\r'; break;
+        case 't': *c = '\t'; break;
+        case '"':
+        case '\\':
+        case '/':
+            break;
+        case 'u': {
+            int v = 0;
+            for( uint8_t i = 0; i < 4; i++ ) {
+                int h;
+                if( !doc_getc(p, end, level, c) || (h = hex_val(*c)) < 0 ) {
+                    return false;
+                }
+                v = (v << 4) | h;
+            }
+            if( v == 0 || v > 0x7F ) {
+                // Nothing nano_node emits; not worth a UTF-8 encoder
+                return false;
+            }
+            *c = (char)v;
+            break;
+        }
+        default:
+            return false;
+    }
+    return true;
+}
+
+void nanoparse_json_init(nanoparse_json_t *lex, const char *data, size_t len){
+    lex->pos = data;
+    lex->end = data + len;
+    lex->depth = 0;
+    lex->level = 0;
+}
+
+jolt_err_t nanoparse_json_init_nested(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *str){
+    if( NANOPARSE_JSON_STRING != str->type
+            || str->level >= NANOPARSE_JSON_MAX_LEVEL ) {
+        return E_FAILURE;
+    }
+    nanoparse_json_init(lex, str->start, str->len);
+    lex->level = str->level + 1;
+    return E_SUCCESS;
+}
+
+nanoparse_json_type_t nanoparse_json_next(nanoparse_json_t *lex,
+        nanoparse_json_tok_t *tok){
+    const char *p = lex->pos;
+    const char *q = p;
+    char c;
+
+    for(;;) {
+        q = p;
+        if( !doc_getc(&q, lex->end, lex->level, &c) ) {
+            if( q < lex->end && '\0' != *q ) {
+                goto error;
+            }
+            tok->type = NANOPARSE_JSON_END;
+            tok->start = p;
+            tok->len = 0;
+            tok->level = lex->level;
+            lex->pos = p;
+            return tok->type;
+        }
+        if( !is_space(c) ) {
+            break;
+        }
+        p = q;
+    }
+
+    // "p" is the raw start of the token, "q" just past its first character
+    tok->start = p;
+    tok->len = q - p;
+    tok->level = lex->level;
+    switch( c ) {
+        case '{':
+        case '[':
+            if( UINT8_MAX == lex->depth ) {
+                goto error;
+            }
+            tok->type = ('{' == c) ? NANOPARSE_JSON_OBJECT : NANOPARSE_JSON_ARRAY;
+            lex->depth++;
+            break;
+        case '}':
+        case ']':
+            if( 0 == lex->depth ) {
+                goto error;
+            }
+            tok->type = ('}' == c) ? NANOPARSE_JSON_OBJECT_END : NANOPARSE_JSON_ARRAY_END;
+            lex->depth--;
+            break;
+        case ':':
+            tok->type = NANOPARSE_JSON_COLON;
+            break;
+        case ',':
+            tok->type = NANOPARSE_JSON_COMMA;
+            break;
+        case '"': {
+            const char *r;
+            tok->start = q;
+            for(;;) {
+                r = q;
+                if( !doc_getc(&q, lex->end, lex->level, &c) ) {
+                    goto error;
+                }
+                if( '"' == c ) {
+                    break;
+                }
+                if( '\\' == c && !doc_getc(&q, lex->end, lex->level, &c) ) {
+                    goto error;
+                }
+            }
+            tok->type = NANOPARSE_JSON_STRING;
+            tok->len = r - tok->start;
+            break;
+        }
+        default: {
+            const char *r;
+            if( !is_primitive(c) ) {
+                goto error;
+            }
+            for(;;) {
+                r = q;
+                if( !doc_getc(&q, lex->end, lex->level, &c) || !is_primitive(c) ) {
+                    q = r;
+                    break;
+                }
+            }
+            tok->type = NANOPARSE_JSON_PRIMITIVE;
+            tok->len = q - p;
+            break;
+        }
+    }
+    lex->pos = q;
+    return tok->type;
+
+error:
+    tok->type = NANOPARSE_JSON_ERROR;
+    lex->pos = lex->end;
+    return tok->type;
+}
+
+jolt_err_t nanoparse_json_skip(nanoparse_json_t *lex, uint8_t depth){
+    nanoparse_json_tok_t tok;
+    while( lex->depth > depth ) {
+        switch( nanoparse_json_next(lex, &tok) ) {
+            case NANOPARSE_JSON_ERROR:
+            case NANOPARSE_JSON_END:
+                return E_FAILURE;
+            default:
+                break;
+        }
+    }
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_json_object(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *open,
+        nanoparse_json_member_cb_t cb, void *ctx){
+    jolt_err_t res;
+    nanoparse_json_tok_t key, tok, value;
+    uint8_t depth;
+
+    if( NANOPARSE_JSON_OBJECT != open->type ) {
+        return E_FAILURE;
+    }
+    depth = lex->depth;
+
+    if( NANOPARSE_JSON_OBJECT_END == nanoparse_json_next(lex, &key) ) {
+        return E_SUCCESS;
+    }
+    for(;;) {
+        if( NANOPARSE_JSON_STRING != key.type
+                || NANOPARSE_JSON_COLON != nanoparse_json_next(lex, &tok) ) {
+            return E_FAILURE;
+        }
+        switch( nanoparse_json_next(lex, &value) ) {
+            case NANOPARSE_JSON_OBJECT:
+            case NANOPARSE_JSON_ARRAY:
+            case NANOPARSE_JSON_STRING:
+            case NANOPARSE_JSON_PRIMITIVE:
+                break;
+            default:
+                return E_FAILURE;
+        }
+
+        res = cb(lex, &key, &value, ctx);
+        if( E_SUCCESS != res ) {
+            return res;
+        }
+        if( E_SUCCESS != nanoparse_json_skip(lex, depth) ) {
+            return E_FAILURE;
+        }
+
+        switch( nanoparse_json_next(lex, &tok) ) {
+            case NANOPARSE_JSON_COMMA:
+                nanoparse_json_next(lex, &key);
+                break;
+            case NANOPARSE_JSON_OBJECT_END:
+                return E_SUCCESS;
+            default:
+                return E_FAILURE;
+        }
+    }
+}
+
+jolt_err_t nanoparse_json_array(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *open,
+        nanoparse_json_element_cb_t cb, void *ctx){
+    jolt_err_t res;
+    nanoparse_json_tok_t tok, value;
+    uint8_t depth;
+
+    if( NANOPARSE_JSON_ARRAY != open->type ) {
+        return E_FAILURE;
+    }
+    depth = lex->depth;
+
+    if( NANOPARSE_JSON_ARRAY_END == nanoparse_json_next(lex, &value) ) {
+        return E_SUCCESS;
+    }
+    for(;;) {
+        switch( value.type ) {
+            case NANOPARSE_JSON_OBJECT:
+            case NANOPARSE_JSON_ARRAY:
+            case NANOPARSE_JSON_STRING:
+            case NANOPARSE_JSON_PRIMITIVE:
+                break;
+            default:
+                return E_FAILURE;
+        }
+
+        res = cb(lex, &value, ctx);
+        if( E_SUCCESS != res ) {
+            return res;
+        }
+        if( E_SUCCESS != nanoparse_json_skip(lex, depth) ) {
+            return E_FAILURE;
+        }
+
+        switch( nanoparse_json_next(lex, &tok) ) {
+            case NANOPARSE_JSON_COMMA:
+                nanoparse_json_next(lex, &value);
+                break;
+            case NANOPARSE_JSON_ARRAY_END:
+                return E_SUCCESS;
+            default:
+                return E_FAILURE;
+        }
+    }
+}
+
+bool nanoparse_json_tok_eq(const nanoparse_json_tok_t *tok, const char *str){
+    size_t len = strlen(str);
+    const char *p, *end;
+    char c;
+
+    if( tok->len == len && 0 == memcmp(tok->start, str, len) ) {
+        return true;
+    }
+    if( NULL == memchr(tok->start, '\\', tok->len) ) {
+        return false;
+    }
+
+    p = tok->start;
+    end = tok->start + tok->len;
+    while( string_getc(&p, end, tok->level, &c) ) {
+        if( c != *str++ ) {
+            return false;
+        }
+    }
+    return p == end && '\0' == *str;
+}
+
+jolt_err_t nanoparse_json_tok_str(const nanoparse_json_tok_t *tok,
+        char *buf, size_t buf_len){
+    const char *p = tok->start;
+    const char *end = tok->start + tok->len;
+    size_t n = 0;
+    char c;
+
+    while( string_getc(&p, end, tok->level, &c) ) {
+        if( n + 1 >= buf_len ) {
+            return E_INSUFFICIENT_BUF;
+        }
+        buf[n++] = c;
+    }
+    if( p != end || 0 == buf_len ) {
+        return E_FAILURE;
+    }
+    buf[n] = '\0';
+    return E_SUCCESS;
+}
@@ -0,0 +1,90 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+/* Private to nano_parse: a small pull tokenizer used by the heap-free
+ * backends. Tokens are spans into the caller's buffer; nothing is copied
+ * and nothing is allocated. */
+
+#ifndef __NANO_PARSE_JSON_H__
+#define __NANO_PARSE_JSON_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "jolttypes.h"
+
+typedef enum nanoparse_json_type_t {
+    NANOPARSE_JSON_ERROR = 0,
+    NANOPARSE_JSON_END,
+    NANOPARSE_JSON_OBJECT,
+    NANOPARSE_JSON_OBJECT_END,
+    NANOPARSE_JSON_ARRAY,
+    NANOPARSE_JSON_ARRAY_END,
+    NANOPARSE_JSON_COLON,
+    NANOPARSE_JSON_COMMA,
+    NANOPARSE_JSON_STRING,
+    NANOPARSE_JSON_PRIMITIVE,
+} nanoparse_json_type_t;
+
+/* A document embedded in a JSON string (e.g. the legacy "contents" block)
+ * is read at level 1: the outer string escaping is undone on the fly, so
+ * \" is a quote and \n is whitespace. Spans always point at the raw (still
+ * escaped) input. */
+#define NANOPARSE_JSON_MAX_LEVEL 1
+
+typedef struct nanoparse_json_tok_t {
+    nanoparse_json_type_t type;
+    const char *start; // For strings: first char after the opening quote
+    size_t len;        // For strings: excludes quotes; escapes left as-is
+    uint8_t level;     // Escaping level of the document the token is from
+} nanoparse_json_tok_t;
+
+typedef struct nanoparse_json_t {
+    const char *pos;   // Next unread character
+    const char *end;   // One past the last readable character
+    uint8_t depth;     // Current object/array nesting
+    uint8_t level;     // See NANOPARSE_JSON_MAX_LEVEL
+} nanoparse_json_t;
+
+/* Called once per object member. "value" is the first token of the value;
+ * compound values that the callback leaves unconsumed are skipped. */
+typedef jolt_err_t (*nanoparse_json_member_cb_t)(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value,
+        void *ctx);
+
+/* Called once per array element, same rules as nanoparse_json_member_cb_t */
+typedef jolt_err_t (*nanoparse_json_element_cb_t)(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *value, void *ctx);
+
+void nanoparse_json_init(nanoparse_json_t *lex, const char *data, size_t len);
+
+/* Reads the JSON document stored inside a string token in place */
+jolt_err_t nanoparse_json_init_nested(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *str);
+
+nanoparse_json_type_t nanoparse_json_next(nanoparse_json_t *lex,
+        nanoparse_json_tok_t *tok);
+
+/* Consumes tokens until the nesting returns to "depth" */
+jolt_err_t nanoparse_json_skip(nanoparse_json_t *lex, uint8_t depth);
+
+/* Walks the members of the object opened by "open" (already consumed) */
+jolt_err_t nanoparse_json_object(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *open,
+        nanoparse_json_member_cb_t cb, void *ctx);
+
+/* Walks the elements of the array opened by "open" (already consumed) */
+jolt_err_t nanoparse_json_array(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *open,
+        nanoparse_json_element_cb_t cb, void *ctx);
+
+bool nanoparse_json_tok_eq(const nanoparse_json_tok_t *tok, const char *str);
+
+/* Copies a string token into a null-terminated buffer, decoding escapes.
+ * Returns E_INSUFFICIENT_BUF if it doesn't fit. */
+jolt_err_t nanoparse_json_tok_str(const nanoparse_json_tok_t *tok,
+        char *buf, size_t buf_len);
+
+#endif
@@ -0,0 +1,90 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <string.h>
+
+#include "nano_lib.h"
+#include "nano_parse_keys.h"
+
+/* The hash functions were searched for offline so that every name lands
+ * in its own slot; a lookup confirms the slot with a single memcmp. If a
+ * name is added, both the slot layout and possibly the constants must be
+ * recomputed. */
+#define KEY_HASH(str, len) \
+        (((len) * 3 + (uint8_t)(str)[0] * 2 + (uint8_t)(str)[(len) - 1] * 4) & 0x0F)
+#define TYPE_HASH(str, len) \
+        (((len) + (uint8_t)(str)[0] * 3 + (uint8_t)(str)[(len) - 1]) & 0x07)
+
+typedef struct key_slot_t {
+    const char *name;
+    uint8_t len;
+    nanoparse_key_t key;
+} key_slot_t;
+
+#define KEY_SLOT(str, k) { str, sizeof(str) - 1, k }
+#define KEY_EMPTY { NULL, 0, NANOPARSE_KEY_UNKNOWN }
+
+static const key_slot_t key_table[16] = {
+    /*  0 */ KEY_SLOT("link", NANOPARSE_KEY_LINK),
+    /*  1 */ KEY_SLOT("destination", NANOPARSE_KEY_DESTINATION),
+    /*  2 */ KEY_SLOT("representative", NANOPARSE_KEY_REPRESENTATIVE),
+    /*  3 */ KEY_EMPTY,
+    /*  4 */ KEY_SLOT("previous", NANOPARSE_KEY_PREVIOUS),
+    /*  5 */ KEY_SLOT("signature", NANOPARSE_KEY_SIGNATURE),
+    /*  6 */ KEY_SLOT("work", NANOPARSE_KEY_WORK),
+    /*  7 */ KEY_SLOT("account", NANOPARSE_KEY_ACCOUNT),
+    /*  8 */ KEY_SLOT("type", NANOPARSE_KEY_TYPE),
+    /*  9 */ KEY_EMPTY,
+    /* 10 */ KEY_SLOT("contents", NANOPARSE_KEY_CONTENTS),
+    /* 11 */ KEY_EMPTY,
+    /* 12 */ KEY_SLOT("source", NANOPARSE_KEY_SOURCE),
+    /* 13 */ KEY_SLOT("balance", NANOPARSE_KEY_BALANCE),
+    /* 14 */ KEY_EMPTY,
+    /* 15 */ KEY_SLOT("block", NANOPARSE_KEY_BLOCK),
+};
+
+typedef struct type_slot_t {
+    const char *name;
+    uint8_t len;
+    nanoparse_block_type_t info;
+} type_slot_t;
+
+#define TYPE_SLOT(str, t, n) { str, sizeof(str) - 1, { t, n } }
+#define TYPE_EMPTY { NULL, 0, { UNDEFINED, 0 } }
+
+static const type_slot_t type_table[8] = {
+    /* 0 */ TYPE_EMPTY,
+    /* 1 */ TYPE_SLOT("send", SEND, 4),
+    /* 2 */ TYPE_SLOT("receive", RECEIVE, 3),
+    /* 3 */ TYPE_SLOT("state", STATE, 6),
+    /* 4 */ TYPE_SLOT("change", CHANGE, 3),
+    /* 5 */ TYPE_EMPTY,
+    /* 6 */ TYPE_EMPTY,
+    /* 7 */ TYPE_SLOT("open", OPEN, 4),
+};
+
+nanoparse_key_t nanoparse_key_lookup(const char *str, size_t len){
+    const key_slot_t *slot;
+    if( 0 == len || len > NANOPARSE_KEY_MAX_LEN ) {
+        return NANOPARSE_KEY_UNKNOWN;
+    }
+    slot = &key_table[KEY_HASH(str, len)];
+    if( slot->len != len || 0 != memcmp(slot->name, str, len) ) {
+        return NANOPARSE_KEY_UNKNOWN;
+    }
+    return slot->key;
+}
+
+const nanoparse_block_type_t *nanoparse_block_type_lookup(const char *str, size_t len){
+    const type_slot_t *slot;
+    if( 0 == len || len > NANOPARSE_KEY_MAX_LEN ) {
+        return NULL;
+    }
+    slot = &type_table[TYPE_HASH(str, len)];
+    if( slot->len != len || 0 != memcmp(slot->name, str, len) ) {
+        return NULL;
+    }
+    return &slot->info;
+}
@@ -0,0 +1,46 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+/* Private to nano_parse: perfect-hash lookup of block member names and
+ * block type names. Each lookup is one hash and at most one memcmp. */
+
+#ifndef __NANO_PARSE_KEYS_H__
+#define __NANO_PARSE_KEYS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "nano_lib.h"
+
+typedef enum nanoparse_key_t {
+    NANOPARSE_KEY_TYPE = 0,
+    NANOPARSE_KEY_ACCOUNT,
+    NANOPARSE_KEY_PREVIOUS,
+    NANOPARSE_KEY_REPRESENTATIVE,
+    NANOPARSE_KEY_SIGNATURE,
+    NANOPARSE_KEY_LINK,
+    NANOPARSE_KEY_SOURCE,
+    NANOPARSE_KEY_DESTINATION,
+    NANOPARSE_KEY_WORK,
+    NANOPARSE_KEY_BALANCE,
+    NANOPARSE_KEY_CONTENTS,
+    NANOPARSE_KEY_BLOCK,
+    NANOPARSE_KEY_N,
+    NANOPARSE_KEY_UNKNOWN = NANOPARSE_KEY_N,
+} nanoparse_key_t;
+
+/* Longest name in either table; longer strings are never a match */
+#define NANOPARSE_KEY_MAX_LEN 14
+
+typedef struct nanoparse_block_type_t {
+    nl_block_type_t type;
+    uint8_t expected_n_parse; // Mandatory fields, "type" included
+} nanoparse_block_type_t;
+
+nanoparse_key_t nanoparse_key_lookup(const char *str, size_t len);
+
+/* Returns NULL if str isn't a block type */
+const nanoparse_block_type_t *nanoparse_block_type_lookup(const char *str, size_t len);
+
+#endif
@@ -0,0 +1,63 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+/* Private to nano_parse: compile-time gated logging.
+ *
+ * Every call site names a site bit and a level. A call below
+ * CONFIG_NANOPARSE_LOG_LEVEL, or whose site is masked out of
+ * CONFIG_NANOPARSE_LOG_SITES, becomes `if( 0 )`: its arguments are still
+ * type checked but never evaluated, so nothing is formatted or converted
+ * for it. Calls that pass still go through esp_log and its runtime level.
+ *
+ * Field values and whole requests/responses are only traced at VERBOSE;
+ * failures log at ERROR or INFO as before. */
+
+#ifndef __NANO_PARSE_LOG_H__
+#define __NANO_PARSE_LOG_H__
+
+#include "esp_log.h"
+
+/* Levels; same numbering as esp_log_level_t */
+#define NANOPARSE_LOG_NONE    0
+#define NANOPARSE_LOG_ERROR   1
+#define NANOPARSE_LOG_WARN    2
+#define NANOPARSE_LOG_INFO    3
+#define NANOPARSE_LOG_DEBUG   4
+#define NANOPARSE_LOG_VERBOSE 5
+
+/* Call sites */
+#define NANOPARSE_LOG_SITE_BLOCK       0x01 // nanoparse_block, both backends
+#define NANOPARSE_LOG_SITE_BLOCKS_INFO 0x02
+#define NANOPARSE_LOG_SITE_PENDING     0x04 // accounts_pending, whole and chunked
+#define NANOPARSE_LOG_SITE_FRONTIERS   0x08
+#define NANOPARSE_LOG_SITE_PROCESS     0x10
+#define NANOPARSE_LOG_SITE_SCHEMA      0x20 // Table-driven responses
+#define NANOPARSE_LOG_SITE_WEB         0x40
+
+#ifndef CONFIG_NANOPARSE_LOG_LEVEL
+#define CONFIG_NANOPARSE_LOG_LEVEL NANOPARSE_LOG_INFO
+#endif
+
+#ifndef CONFIG_NANOPARSE_LOG_SITES
+#define CONFIG_NANOPARSE_LOG_SITES 0x7F
+#endif
+
+#define NANOPARSE_LOG_ENABLED(level, site) \
+    ( (level) <= CONFIG_NANOPARSE_LOG_LEVEL \
+      && 0 != ((CONFIG_NANOPARSE_LOG_SITES) & NANOPARSE_LOG_SITE_##site) )
+
+#define NANOPARSE_LOG(esp_log, level, site, ...) do { \
+    if( NANOPARSE_LOG_ENABLED(NANOPARSE_LOG_##level, site) ) { \
+        esp_log(TAG, __VA_ARGS__); \
+    } \
+} while(0)
+
+#define NANOPARSE_LOGE(site, ...) NANOPARSE_LOG(ESP_LOGE, ERROR, site, __VA_ARGS__)
+#define NANOPARSE_LOGW(site, ...) NANOPARSE_LOG(ESP_LOGW, WARN, site, __VA_ARGS__)
+#define NANOPARSE_LOGI(site, ...) NANOPARSE_LOG(ESP_LOGI, INFO, site, __VA_ARGS__)
+#define NANOPARSE_LOGD(site, ...) NANOPARSE_LOG(ESP_LOGD, DEBUG, site, __VA_ARGS__)
+#define NANOPARSE_LOGV(site, ...) NANOPARSE_LOG(ESP_LOGV, VERBOSE, site, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,154 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jolttypes.h"
+#include "nano_parse.h"
+
+#if CONFIG_NANOPARSE_POOL_MAX_LEN < NANOPARSE_POOL_MIN_LEN
+#error "CONFIG_NANOPARSE_POOL_MAX_LEN must be at least NANOPARSE_POOL_MIN_LEN"
+#endif
+
+#if CONFIG_NANOPARSE_POOL_CACHED < 1
+#error "CONFIG_NANOPARSE_POOL_CACHED must be at least 1"
+#endif
+
+/* Enough for any 32-bit size_t */
+#define POOL_MAX_CLASSES 24
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static char *pool_free[POOL_MAX_CLASSES][CONFIG_NANOPARSE_POOL_CACHED];
+static uint8_t pool_n_free[POOL_MAX_CLASSES];
+static nanoparse_pool_stats_t pool_stats;
+
+static size_t class_len(uint8_t cls) {
+    size_t len = (size_t)NANOPARSE_POOL_MIN_LEN << cls;
+    return len < CONFIG_NANOPARSE_POOL_MAX_LEN ? len : CONFIG_NANOPARSE_POOL_MAX_LEN;
+}
+
+/* Smallest class holding len; POOL_MAX_CLASSES if none does */
+static uint8_t class_of(size_t len) {
+    uint8_t cls = 0;
+    if( len > CONFIG_NANOPARSE_POOL_MAX_LEN ) {
+        return POOL_MAX_CLASSES;
+    }
+    while( class_len(cls) < len ) {
+        cls++;
+    }
+    return cls;
+}
+
+static jolt_err_t pool_take(nanoparse_buf_t *buf, uint8_t cls) {
+    size_t len = class_len(cls);
+    char *data = NULL;
+
+    pthread_mutex_lock(&pool_lock);
+    if( pool_n_free[cls] > 0 ) {
+        data = pool_free[cls][--pool_n_free[cls]];
+        pool_stats.cached -= len;
+        pool_stats.hits++;
+    }
+    else {
+        pool_stats.misses++;
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    if( NULL == data ) {
+        data = malloc(len);
+        if( NULL == data ) {
+            return E_FAILURE;
+        }
+    }
+
+    pthread_mutex_lock(&pool_lock);
+    pool_stats.in_use += len;
+    if( pool_stats.in_use > pool_stats.high_water ) {
+        pool_stats.high_water = pool_stats.in_use;
+    }
+    if( len > pool_stats.largest ) {
+        pool_stats.largest = len;
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    data[0] = '\0';
+    buf->data = data;
+    buf->len = len;
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_pool_get(nanoparse_buf_t *buf, size_t min_len) {
+    uint8_t cls = class_of(min_len);
+
+    buf->data = NULL;
+    buf->len = 0;
+    if( cls >= POOL_MAX_CLASSES ) {
+        return E_INSUFFICIENT_BUF;
+    }
+    return pool_take(buf, cls);
+}
+
+jolt_err_t nanoparse_pool_grow(nanoparse_buf_t *buf) {
+    nanoparse_buf_t bigger;
+    jolt_err_t res;
+
+    if( buf->len >= CONFIG_NANOPARSE_POOL_MAX_LEN ) {
+        return E_INSUFFICIENT_BUF;
+    }
+    res = pool_take(&bigger, class_of(buf->len) + 1);
+    if( E_SUCCESS != res ) {
+        return res;
+    }
+    nanoparse_pool_put(buf);
+    *buf = bigger;
+
+    pthread_mutex_lock(&pool_lock);
+    pool_stats.grows++;
+    pthread_mutex_unlock(&pool_lock);
+    return E_SUCCESS;
+}
+
+void nanoparse_pool_put(nanoparse_buf_t *buf) {
+    uint8_t cls;
+
+    if( NULL == buf->data ) {
+        return;
+    }
+    cls = class_of(buf->len);
+
+    pthread_mutex_lock(&pool_lock);
+    pool_stats.in_use -= buf->len;
+    if( pool_n_free[cls] < CONFIG_NANOPARSE_POOL_CACHED ) {
+        pool_free[cls][pool_n_free[cls]++] = buf->data;
+        pool_stats.cached += buf->len;
+        buf->data = NULL;
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    free(buf->data);
+    buf->data = NULL;
+    buf->len = 0;
+}
+
+void nanoparse_pool_stats(nanoparse_pool_stats_t *stats) {
+    pthread_mutex_lock(&pool_lock);
+    *stats = pool_stats;
+    pthread_mutex_unlock(&pool_lock);
+}
+
+void nanoparse_pool_trim(void) {
+    pthread_mutex_lock(&pool_lock);
+    for( uint8_t cls = 0; cls < POOL_MAX_CLASSES; cls++ ) {
+        while( pool_n_free[cls] > 0 ) {
+            free(pool_free[cls][--pool_n_free[cls]]);
+        }
+    }
+    pool_stats.cached = 0;
+    pthread_mutex_unlock(&pool_lock);
+}
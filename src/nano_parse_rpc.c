@@ -0,0 +1,245 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "nano_lib.h"
+#include "jolttypes.h"
+#include "nano_parse.h"
+#include "nano_parse_hex.h"
+#include "nano_parse_log.h"
+
+#define RPC_CMD_BUF_LEN 256
+
+#if CONFIG_NANOPARSE_JSON_BLOCK
+#define RPC_JSON_BLOCK_ARG ",\"json_block\":\"true\""
+#else
+#define RPC_JSON_BLOCK_ARG ""
+#endif
+
+static const char TAG[] = "nano_parse";
+
+/* Shared by every nanoparse_rpc_t, so contexts on one transport (or one
+ * context re-initialized) never reuse an id that may still be queued */
+static uint32_t rpc_next_id;
+
+void nanoparse_rpc_init(nanoparse_rpc_t *rpc, const nanoparse_transport_t *transport){
+    memset(rpc, 0, sizeof(nanoparse_rpc_t));
+    rpc->transport = transport;
+}
+
+/* hash, if not NULL, is the block the reply must hash to */
+static jolt_err_t rpc_submit(nanoparse_rpc_t *rpc, const char *cmd,
+        nanoparse_rpc_parse_t parse, void *out, nanoparse_rpc_cb_t cb, void *ctx,
+        const uint256_t hash){
+    nanoparse_rpc_slot_t *slot = NULL;
+    jolt_err_t res;
+
+    for( uint8_t i = 0; i < CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT; i++ ){
+        if( !rpc->slots[i].busy ){
+            slot = &rpc->slots[i];
+            break;
+        }
+    }
+    if( NULL == slot ){
+        return E_INSUFFICIENT_BUF;
+    }
+
+    slot->id = __atomic_fetch_add(&rpc_next_id, 1, __ATOMIC_RELAXED);
+    res = rpc->transport->submit(rpc->transport->ctx, slot->id, cmd);
+    if( E_SUCCESS != res ){
+        NANOPARSE_LOGI(WEB, "nanoparse_rpc_submit: transport refused request");
+        return res;
+    }
+    slot->parse = parse;
+    slot->out = out;
+    slot->cb = cb;
+    slot->cb_ctx = ctx;
+    slot->check_hash = (NULL != hash);
+    if( slot->check_hash ){
+        memcpy(slot->hash, hash, sizeof(slot->hash));
+    }
+    slot->busy = true;
+    rpc->in_flight++;
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_rpc_submit(nanoparse_rpc_t *rpc, const char *cmd,
+        nanoparse_rpc_parse_t parse, void *out, nanoparse_rpc_cb_t cb, void *ctx){
+    return rpc_submit(rpc, cmd, parse, out, cb, ctx, NULL);
+}
+
+static jolt_err_t rpc_slot_parse(const nanoparse_rpc_slot_t *slot, const char *reply){
+    /* Same check as nanoparse_web_block: a node can't substitute another
+     * block for the one requested */
+    uint256_t hash;
+    jolt_err_t res;
+
+    if( !slot->check_hash ){
+        return slot->parse(reply, slot->out);
+    }
+    res = nanoparse_block_and_hash(reply, slot->out, hash);
+    if( E_SUCCESS == res && 0 != memcmp(hash, slot->hash, sizeof(hash)) ){
+        NANOPARSE_LOGI(WEB, "nanoparse_rpc_block: block doesn't match its hash");
+        res = E_FAILURE;
+    }
+    return res;
+}
+
+size_t nanoparse_rpc_poll(nanoparse_rpc_t *rpc){
+    const char *reply;
+    uint32_t id;
+    size_t n = 0;
+
+    while( rpc->in_flight > 0
+            && E_SUCCESS == rpc->transport->poll(rpc->transport->ctx, &id, &reply) ){
+        nanoparse_rpc_slot_t *slot = NULL;
+        nanoparse_rpc_slot_t done;
+
+        for( uint8_t i = 0; i < CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT; i++ ){
+            if( rpc->slots[i].busy && id == rpc->slots[i].id ){
+                slot = &rpc->slots[i];
+                break;
+            }
+        }
+        if( NULL == slot ){
+            NANOPARSE_LOGI(WEB, "nanoparse_rpc_poll: reply for unknown id %u",
+                    (unsigned int)id);
+            continue;
+        }
+
+        // Free the slot first so the callback can submit a follow-up
+        done = *slot;
+        slot->busy = false;
+        rpc->in_flight--;
+        n++;
+        if( NULL != done.cb ){
+            done.cb(rpc_slot_parse(&done, reply), done.out, done.cb_ctx);
+        }
+        else{
+            rpc_slot_parse(&done, reply);
+        }
+    }
+    return n;
+}
+
+size_t nanoparse_rpc_cancel(nanoparse_rpc_t *rpc){
+    size_t n = 0;
+
+    for( uint8_t i = 0; i < CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT; i++ ){
+        nanoparse_rpc_slot_t done = rpc->slots[i];
+
+        if( !done.busy ){
+            continue;
+        }
+        // A reply that turns up later is dropped as an unknown id
+        if( NULL != rpc->transport->cancel ){
+            rpc->transport->cancel(rpc->transport->ctx, done.id);
+        }
+        rpc->slots[i].busy = false;
+        rpc->in_flight--;
+        n++;
+        if( NULL != done.cb ){
+            done.cb(E_FAILURE, done.out, done.cb_ctx);
+        }
+    }
+    return n;
+}
+
+static uint64_t rpc_now_ms(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+jolt_err_t nanoparse_rpc_wait(nanoparse_rpc_t *rpc, uint32_t timeout_ms){
+    uint64_t deadline = rpc_now_ms() + timeout_ms;
+
+    while( rpc->in_flight > 0 ){
+        nanoparse_rpc_poll(rpc);
+        if( rpc->in_flight > 0 && rpc_now_ms() >= deadline ){
+            NANOPARSE_LOGI(WEB, "nanoparse_rpc_wait: %u requests timed out",
+                    (unsigned int)rpc->in_flight);
+            nanoparse_rpc_cancel(rpc);
+            return E_FAILURE;
+        }
+    }
+    return E_SUCCESS;
+}
+
+/* Adapters from the typed parsers to nanoparse_rpc_parse_t */
+static jolt_err_t parse_account_info(const char *json_data, void *out){
+    return nanoparse_account_info(json_data, out);
+}
+
+static jolt_err_t parse_account_balance(const char *json_data, void *out){
+    return nanoparse_account_balance(json_data, out);
+}
+
+static jolt_err_t parse_next_block(const char *json_data, void *out){
+    return nanoparse_next_block(json_data, out);
+}
+
+jolt_err_t nanoparse_rpc_block(nanoparse_rpc_t *rpc, const hex256_t block_hash,
+        nl_block_t *block, nanoparse_rpc_cb_t cb, void *ctx){
+    char rpc_command[RPC_CMD_BUF_LEN];
+    uint256_t hash;
+
+    if( E_SUCCESS != nanoparse_hex_decode(hash, sizeof(hash), block_hash,
+                strlen(block_hash)) ){
+        return E_FAILURE;
+    }
+    snprintf(rpc_command, sizeof(rpc_command),
+            "{\"action\":\"block\",\"hash\":\"%s\"" RPC_JSON_BLOCK_ARG "}",
+            block_hash);
+    // Parsed with nanoparse_block_and_hash by rpc_slot_parse
+    return rpc_submit(rpc, rpc_command, NULL, block, cb, ctx, hash);
+}
+
+jolt_err_t nanoparse_rpc_account_info(nanoparse_rpc_t *rpc,
+        const char *account_address, nanoparse_account_info_t *info,
+        nanoparse_rpc_cb_t cb, void *ctx){
+    char rpc_command[RPC_CMD_BUF_LEN];
+
+    snprintf(rpc_command, sizeof(rpc_command),
+            "{\"action\":\"account_info\",\"representative\":\"true\","
+            "\"account\":\"%s\"}",
+            account_address);
+    return nanoparse_rpc_submit(rpc, rpc_command, parse_account_info, info, cb, ctx);
+}
+
+jolt_err_t nanoparse_rpc_account_balance(nanoparse_rpc_t *rpc,
+        const char *account_address, nanoparse_account_balance_t *balance,
+        nanoparse_rpc_cb_t cb, void *ctx){
+    char rpc_command[RPC_CMD_BUF_LEN];
+
+    snprintf(rpc_command, sizeof(rpc_command),
+            "{\"action\":\"account_balance\",\"account\":\"%s\"}",
+            account_address);
+    return nanoparse_rpc_submit(rpc, rpc_command, parse_account_balance,
+            balance, cb, ctx);
+}
+
+jolt_err_t nanoparse_rpc_next_block(nanoparse_rpc_t *rpc, nl_block_t *block,
+        nanoparse_rpc_cb_t cb, void *ctx){
+    char rpc_command[RPC_CMD_BUF_LEN];
+    char address[ADDRESS_BUF_LEN];
+    jolt_err_t res;
+
+    res = nl_public_to_address(address, sizeof(address), block->account);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+    snprintf(rpc_command, sizeof(rpc_command),
+            "{\"action\":\"account_info\",\"representative\":\"true\","
+            "\"account\":\"%s\"}",
+            address);
+    return nanoparse_rpc_submit(rpc, rpc_command, parse_next_block, block, cb, ctx);
+}
@@ -0,0 +1,223 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nano_lib.h"
+#include "jolttypes.h"
+#include "nano_parse.h"
+#include "nano_parse_hex.h"
+#include "nano_parse_json.h"
+#include "nano_parse_log.h"
+#include "nano_parse_schema.h"
+
+static const char TAG[] = "nano_parse";
+
+/* Longest path component that an escaped key is decoded for */
+#define SCHEMA_KEY_MAX_LEN 32
+
+typedef jolt_err_t (*field_decoder_t)(void *dst, const nanoparse_json_tok_t *tok);
+
+typedef struct schema_ctx_t {
+    const nanoparse_schema_t *schema;
+    uint8_t *dst;
+    uint32_t *seen;   // Fields already decoded
+    uint32_t active;  // Fields whose path matched every level so far
+    uint8_t level;
+    size_t index;     // Members visited in the current object
+} schema_ctx_t;
+
+static jolt_err_t decode_u32(void *dst, const nanoparse_json_tok_t *tok){
+    uint32_t v = 0;
+    if( 0 == tok->len || tok->len > 10 ) {
+        return E_FAILURE;
+    }
+    for( size_t i = 0; i < tok->len; i++ ) {
+        uint8_t d = tok->start[i] - '0';
+        if( d > 9 || v > (UINT32_MAX - d) / 10 ) {
+            return E_FAILURE;
+        }
+        v = v * 10 + d;
+    }
+    *(uint32_t *)dst = v;
+    return E_SUCCESS;
+}
+
+static jolt_err_t decode_work(void *dst, const nanoparse_json_tok_t *tok){
+    return nanoparse_hex_decode_work(dst, tok->start, tok->len);
+}
+
+static jolt_err_t decode_hash(void *dst, const nanoparse_json_tok_t *tok){
+    return nanoparse_hex_decode(dst, sizeof(uint256_t), tok->start, tok->len);
+}
+
+static jolt_err_t decode_hash_hex(void *dst, const nanoparse_json_tok_t *tok){
+    uint256_t bin;
+    if( E_SUCCESS != nanoparse_hex_decode(bin, sizeof(bin), tok->start, tok->len) ) {
+        return E_FAILURE;
+    }
+    memcpy(dst, tok->start, tok->len);
+    ((char *)dst)[tok->len] = '\0';
+    return E_SUCCESS;
+}
+
+static jolt_err_t decode_address(void *dst, const nanoparse_json_tok_t *tok){
+    char address[ADDRESS_BUF_LEN];
+    if( E_SUCCESS != nanoparse_json_tok_str(tok, address, sizeof(address)) ) {
+        return E_FAILURE;
+    }
+    return nl_address_to_public(dst, address);
+}
+
+static jolt_err_t decode_amount(void *dst, const nanoparse_json_tok_t *tok){
+    return nanoparse_amount_from_dec(dst, tok->start, tok->len);
+}
+
+static const field_decoder_t decoders[NANOPARSE_FIELD_TYPE_N] = {
+    [NANOPARSE_FIELD_U32] = decode_u32,
+    [NANOPARSE_FIELD_WORK] = decode_work,
+    [NANOPARSE_FIELD_HASH] = decode_hash,
+    [NANOPARSE_FIELD_HASH_HEX] = decode_hash_hex,
+    [NANOPARSE_FIELD_ADDRESS] = decode_address,
+    [NANOPARSE_FIELD_AMOUNT] = decode_amount,
+};
+
+static bool path_component(const char *path, uint8_t level,
+        const char **comp, size_t *len, bool *last){
+    /* Finds the level'th '/'-separated component of path */
+    for( ; level > 0; level-- ) {
+        path = strchr(path, '/');
+        if( NULL == path ) {
+            return false;
+        }
+        path++;
+    }
+    *comp = path;
+    *len = strcspn(path, "/");
+    *last = ('\0' == path[*len]);
+    return true;
+}
+
+static bool key_matches(const nanoparse_json_tok_t *key, const char *comp, size_t len){
+    char buf[SCHEMA_KEY_MAX_LEN + 1];
+    if( key->len == len && 0 == memcmp(key->start, comp, len) ) {
+        return true;
+    }
+    if( NULL == memchr(key->start, '\\', key->len)
+            || E_SUCCESS != nanoparse_json_tok_str(key, buf, sizeof(buf)) ) {
+        return false;
+    }
+    return strlen(buf) == len && 0 == memcmp(buf, comp, len);
+}
+
+static jolt_err_t schema_decode(schema_ctx_t *c, uint8_t i,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value){
+    const nanoparse_field_t *field = &c->schema->fields[i];
+    const nanoparse_json_tok_t *tok = value;
+
+    if( field->flags & NANOPARSE_FIELD_KEY ) {
+        tok = key;
+    }
+    else if( NANOPARSE_JSON_STRING != value->type
+            && !(NANOPARSE_FIELD_U32 == field->type
+                && NANOPARSE_JSON_PRIMITIVE == value->type) ) {
+        NANOPARSE_LOGI(SCHEMA, "%s: \"%s\" has the wrong type", c->schema->name, field->path);
+        return E_FAILURE;
+    }
+    if( field->type >= NANOPARSE_FIELD_TYPE_N
+            || E_SUCCESS != decoders[field->type](c->dst + field->offset, tok) ) {
+        NANOPARSE_LOGI(SCHEMA, "%s: bad \"%s\"", c->schema->name, field->path);
+        return E_FAILURE;
+    }
+    *c->seen |= (uint32_t)1 << i;
+    return E_SUCCESS;
+}
+
+static jolt_err_t schema_member_cb(nanoparse_json_t *lex,
+        const nanoparse_json_tok_t *key, const nanoparse_json_tok_t *value,
+        void *ctx){
+    schema_ctx_t *c = ctx;
+    schema_ctx_t next = *c;
+    jolt_err_t res;
+
+    next.active = 0;
+    next.level = c->level + 1;
+    next.index = 0;
+
+    for( uint8_t i = 0; i < c->schema->n_fields; i++ ) {
+        const char *comp;
+        size_t len;
+        bool last, match;
+
+        if( !(c->active & ((uint32_t)1 << i))
+                || !path_component(c->schema->fields[i].path, c->level, &comp, &len, &last) ) {
+            continue;
+        }
+        if( 1 == len && '*' == comp[0] ) {
+            match = (0 == c->index);
+        }
+        else {
+            match = key_matches(key, comp, len);
+        }
+        if( !match ) {
+            continue;
+        }
+        if( !last ) {
+            next.active |= (uint32_t)1 << i;
+        }
+        else if( !(*c->seen & ((uint32_t)1 << i)) ) {
+            res = schema_decode(c, i, key, value);
+            if( E_SUCCESS != res ) {
+                return res;
+            }
+        }
+    }
+    c->index++;
+
+    if( 0 != next.active && NANOPARSE_JSON_OBJECT == value->type ) {
+        return nanoparse_json_object(lex, value, schema_member_cb, &next);
+    }
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_schema_parse(const nanoparse_schema_t *schema,
+        const char *json_data, void *dst){
+    jolt_err_t res;
+    uint32_t seen = 0;
+    schema_ctx_t ctx;
+    nanoparse_json_t lex;
+    nanoparse_json_tok_t tok;
+
+    if( schema->n_fields > 32 ) {
+        return E_FAILURE;
+    }
+    ctx.schema = schema;
+    ctx.dst = dst;
+    ctx.seen = &seen;
+    ctx.active = (32 == schema->n_fields) ? UINT32_MAX
+            : ((uint32_t)1 << schema->n_fields) - 1;
+    ctx.level = 0;
+    ctx.index = 0;
+
+    nanoparse_json_init(&lex, json_data, strlen(json_data));
+    nanoparse_json_next(&lex, &tok);
+    res = nanoparse_json_object(&lex, &tok, schema_member_cb, &ctx);
+    if( E_SUCCESS != res ) {
+        NANOPARSE_LOGI(SCHEMA, "%s: failed to parse json data.", schema->name);
+        return res;
+    }
+
+    for( uint8_t i = 0; i < schema->n_fields; i++ ) {
+        if( (schema->fields[i].flags & NANOPARSE_FIELD_REQUIRED)
+                && !(seen & ((uint32_t)1 << i)) ) {
+            NANOPARSE_LOGI(SCHEMA, "%s: Unable to find key '%s'", schema->name,
+                    schema->fields[i].path);
+            return E_FAILURE;
+        }
+    }
+    return E_SUCCESS;
+}
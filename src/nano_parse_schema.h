@@ -0,0 +1,54 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+/* Private to nano_parse: table-driven parsing of simple rpc responses.
+ * A response is described by a static array of field descriptors; a
+ * single heap-free pass over the JSON fills a caller struct from it. */
+
+#ifndef __NANO_PARSE_SCHEMA_H__
+#define __NANO_PARSE_SCHEMA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "jolttypes.h"
+
+typedef enum nanoparse_field_type_t {
+    NANOPARSE_FIELD_U32 = 0, // uint32_t from a decimal string or number
+    NANOPARSE_FIELD_WORK,    // uint64_t from 16 hex characters
+    NANOPARSE_FIELD_HASH,    // uint256_t from 64 hex characters
+    NANOPARSE_FIELD_HASH_HEX,// hex256_t; validated, then copied as-is
+    NANOPARSE_FIELD_ADDRESS, // uint256_t public key from an address
+    NANOPARSE_FIELD_AMOUNT,  // nanoparse_amount_t from a decimal string
+    NANOPARSE_FIELD_TYPE_N,
+} nanoparse_field_type_t;
+
+#define NANOPARSE_FIELD_REQUIRED 0x01
+#define NANOPARSE_FIELD_KEY      0x02 // Decode the member's name, not its value
+
+typedef struct nanoparse_field_t {
+    /* Member names from the top-level object down, separated by '/'.
+     * "*" matches only the first member of its object. */
+    const char *path;
+    nanoparse_field_type_t type;
+    uint16_t offset;  // Into the destination struct
+    uint8_t flags;
+} nanoparse_field_t;
+
+typedef struct nanoparse_schema_t {
+    const char *name; // For logging
+    const nanoparse_field_t *fields;
+    uint8_t n_fields; // At most 32
+} nanoparse_schema_t;
+
+#define NANOPARSE_SCHEMA(rpc, field_array) \
+    { rpc, field_array, sizeof(field_array) / sizeof(field_array[0]) }
+
+/* Fills dst from json_data. When a path matches more than once, the first
+ * match wins. Returns E_FAILURE if a value doesn't decode or a required
+ * field is missing. */
+jolt_err_t nanoparse_schema_parse(const nanoparse_schema_t *schema,
+        const char *json_data, void *dst);
+
+#endif
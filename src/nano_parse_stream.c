@@ -0,0 +1,224 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "jolttypes.h"
+#include "nano_parse.h"
+#include "nano_parse_json.h"
+
+/* The scanner only tracks enough state to find record boundaries across
+ * chunks: nesting, whether it is inside a string, and whether the next
+ * string starts a member. Each complete record is wrapped in braces and
+ * parsed with the regular tokenizer. Strings of an array at record_depth
+ * are records of their own, wrapped in brackets. */
+
+static bool stream_is_obj(const nanoparse_stream_t *s, uint8_t depth) {
+    return depth >= 1 && depth <= 8 && (s->obj_mask & (1 << (depth - 1)));
+}
+
+static void stream_open(nanoparse_stream_t *s, bool obj) {
+    if( UINT8_MAX == s->depth ) {
+        s->err = E_FAILURE;
+        return;
+    }
+    s->depth++;
+    if( s->depth <= 8 ) {
+        if( obj ) {
+            s->obj_mask |= 1 << (s->depth - 1);
+        }
+        else {
+            s->obj_mask &= ~(1 << (s->depth - 1));
+        }
+    }
+}
+
+static void stream_close(nanoparse_stream_t *s) {
+    if( 0 == s->depth ) {
+        s->err = E_FAILURE;
+        return;
+    }
+    s->depth--;
+}
+
+static void stream_append(nanoparse_stream_t *s, const char *str, size_t len) {
+    if( s->len + len > sizeof(s->buf) ) {
+        s->err = E_INSUFFICIENT_BUF;
+        return;
+    }
+    memcpy(&s->buf[s->len], str, len);
+    s->len += len;
+}
+
+static void stream_deliver(nanoparse_stream_t *s, const char *tail) {
+    stream_append(s, tail, strlen(tail));
+    if( E_SUCCESS == s->err ) {
+        s->err = s->record_cb(s, s->buf, s->len);
+    }
+    s->capturing = false;
+}
+
+static void stream_descend(nanoparse_stream_t *s, bool obj) {
+    /* The buffer holds '{"key":'; remember the key, then hand the member
+     * over with an empty object so the consumer sees it was present */
+    nanoparse_json_t lex;
+    nanoparse_json_tok_t tok;
+    char *key = s->path[s->cap_depth - 1];
+
+    nanoparse_json_init(&lex, &s->buf[1], s->len - 1);
+    if( NANOPARSE_JSON_STRING != nanoparse_json_next(&lex, &tok)
+            || E_SUCCESS != nanoparse_json_tok_str(&tok, key, ADDRESS_BUF_LEN) ) {
+        // Not a key any consumer looks for
+        key[0] = '\0';
+    }
+    stream_deliver(s, "{}}");
+    stream_open(s, obj);
+    s->expect_member = obj;
+}
+
+static void stream_capture_char(nanoparse_stream_t *s, char c) {
+    if( s->depth == s->cap_depth && !stream_is_obj(s, s->depth) ) {
+        // After an array element: only the end of the element matters
+        switch( c ) {
+            case ',':
+                stream_deliver(s, "]");
+                return;
+            case ']':
+                stream_deliver(s, "]");
+                stream_close(s);
+                return;
+            default:
+                s->err = E_FAILURE;
+                return;
+        }
+    }
+    if( s->depth == s->cap_depth ) {
+        // At member level: only the end of the member matters
+        switch( c ) {
+            case ',':
+                stream_deliver(s, "}");
+                s->expect_member = true;
+                return;
+            case '}':
+                stream_deliver(s, "}");
+                stream_close(s);
+                s->done = (0 == s->depth);
+                return;
+            case ']':
+                s->err = E_FAILURE;
+                return;
+            case ':':
+                s->seen_colon = true;
+                break;
+            case '{':
+            case '[':
+                if( s->seen_colon && s->cap_depth < s->record_depth ) {
+                    stream_descend(s, '{' == c);
+                    return;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    stream_append(s, &c, 1);
+    switch( c ) {
+        case '{': stream_open(s, true); break;
+        case '[': stream_open(s, false); break;
+        case '}':
+        case ']': stream_close(s); break;
+        case '"': s->in_str = true; break;
+        default: break;
+    }
+}
+
+static void stream_scan_char(nanoparse_stream_t *s, char c) {
+    if( s->done ) {
+        // Nothing but whitespace may follow the document
+        s->err = E_FAILURE;
+        return;
+    }
+    switch( c ) {
+        case '{':
+            stream_open(s, true);
+            s->expect_member = (s->depth <= s->record_depth);
+            break;
+        case '[':
+            stream_open(s, false);
+            s->expect_member = false;
+            break;
+        case '}':
+        case ']':
+            stream_close(s);
+            s->expect_member = false;
+            s->done = (0 == s->depth);
+            break;
+        case ',':
+            s->expect_member = stream_is_obj(s, s->depth)
+                    && s->depth <= s->record_depth;
+            break;
+        case '"':
+            s->in_str = true;
+            if( s->expect_member ) {
+                s->capturing = true;
+                s->cap_depth = s->depth;
+                s->seen_colon = false;
+                s->expect_member = false;
+                s->len = 0;
+                stream_append(s, "{\"", 2);
+            }
+            else if( s->depth == s->record_depth && !stream_is_obj(s, s->depth) ) {
+                s->capturing = true;
+                s->cap_depth = s->depth;
+                s->len = 0;
+                stream_append(s, "[\"", 2);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+jolt_err_t nanoparse_stream_feed(nanoparse_stream_t *s,
+        const char *chunk, size_t len){
+    for( size_t i = 0; i < len && E_SUCCESS == s->err; i++ ) {
+        char c = chunk[i];
+        if( s->in_str ) {
+            if( s->capturing ) {
+                stream_append(s, &c, 1);
+            }
+            if( s->esc ) {
+                s->esc = false;
+            }
+            else if( '\\' == c ) {
+                s->esc = true;
+            }
+            else if( '"' == c ) {
+                s->in_str = false;
+            }
+        }
+        else if( ' ' == c || '\t' == c || '\n' == c || '\r' == c ) {
+            continue;
+        }
+        else if( s->capturing ) {
+            stream_capture_char(s, c);
+        }
+        else {
+            stream_scan_char(s, c);
+        }
+    }
+    return s->err;
+}
+
+jolt_err_t nanoparse_stream_finish(nanoparse_stream_t *s){
+    if( E_SUCCESS != s->err ) {
+        return s->err;
+    }
+    if( !s->done || !s->found ) {
+        return E_FAILURE;
+    }
+    return E_SUCCESS;
+}
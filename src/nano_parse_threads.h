@@ -0,0 +1,25 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+/* Private to nano_parse: sizing for the pthread worker pools used by local
+ * work generation and batch signature verification. */
+
+#ifndef __NANO_PARSE_THREADS_H__
+#define __NANO_PARSE_THREADS_H__
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NANOPARSE_MAX_THREADS 64
+
+/* Cores available to worker threads, at most NANOPARSE_MAX_THREADS */
+uint8_t nanoparse_cores(void);
+
+/* Initializes attr for a thread with at least stack_len bytes of stack;
+ * the platform's pthread default is too small on ESP-IDF */
+void nanoparse_thread_attr_init(pthread_attr_t *attr, size_t stack_len);
+
+#endif
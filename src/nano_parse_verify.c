@@ -0,0 +1,293 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sodium.h>
+#include "mbedtls/bignum.h"
+
+#include "nano_lib.h"
+#include "jolttypes.h"
+#include "nano_parse.h"
+#include "nano_parse_threads.h"
+
+#if CONFIG_NANOPARSE_VERIFY_BATCH_LEN < 1 || CONFIG_NANOPARSE_VERIFY_BATCH_LEN > 255
+#error "CONFIG_NANOPARSE_VERIFY_BATCH_LEN must be between 1 and 255"
+#endif
+
+/* Group order, little-endian */
+static const uint8_t ed25519_l[32] = {
+    0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58,
+    0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10,
+};
+
+/* State block hashes start with 31 zero bytes and the block type */
+#define STATE_PREAMBLE_LEN 32
+#define STATE_PREAMBLE_TYPE 6
+
+jolt_err_t nanoparse_block_hash(const nl_block_t *block, uint256_t hash) {
+    crypto_generichash_state state;
+    uint8_t preamble[STATE_PREAMBLE_LEN] = { 0 };
+    uint8_t balance[16];
+
+    if( 0 != mbedtls_mpi_write_binary(&block->balance, balance, sizeof(balance)) ) {
+        return E_FAILURE;
+    }
+
+    crypto_generichash_init(&state, NULL, 0, BIN_256);
+    switch( block->type ) {
+        case STATE:
+            preamble[STATE_PREAMBLE_LEN - 1] = STATE_PREAMBLE_TYPE;
+            crypto_generichash_update(&state, preamble, sizeof(preamble));
+            crypto_generichash_update(&state, block->account, BIN_256);
+            crypto_generichash_update(&state, block->previous, BIN_256);
+            crypto_generichash_update(&state, block->representative, BIN_256);
+            crypto_generichash_update(&state, balance, sizeof(balance));
+            crypto_generichash_update(&state, block->link, BIN_256);
+            break;
+        case OPEN:
+            crypto_generichash_update(&state, block->link, BIN_256);
+            crypto_generichash_update(&state, block->representative, BIN_256);
+            crypto_generichash_update(&state, block->account, BIN_256);
+            break;
+        case SEND:
+            crypto_generichash_update(&state, block->previous, BIN_256);
+            crypto_generichash_update(&state, block->link, BIN_256);
+            crypto_generichash_update(&state, balance, sizeof(balance));
+            break;
+        case RECEIVE:
+            crypto_generichash_update(&state, block->previous, BIN_256);
+            crypto_generichash_update(&state, block->link, BIN_256);
+            break;
+        case CHANGE:
+            crypto_generichash_update(&state, block->previous, BIN_256);
+            crypto_generichash_update(&state, block->representative, BIN_256);
+            break;
+        default:
+            return E_FAILURE;
+    }
+    crypto_generichash_final(&state, hash, BIN_256);
+    return E_SUCCESS;
+}
+
+/* A signature that passed the cheap checks, with its challenge computed */
+typedef struct sig_prep_t {
+    const uint8_t *r;   // First half of the signature
+    const uint8_t *a;   // Account public key
+    uint8_t s[32];
+    uint8_t h[32];      // Blake2b-512(R || A || block hash) mod l
+} sig_prep_t;
+
+static bool scalar_is_canonical(const uint8_t s[32]) {
+    for( int8_t i = 31; i >= 0; i-- ) {
+        if( s[i] != ed25519_l[i] ) {
+            return s[i] < ed25519_l[i];
+        }
+    }
+    return false;
+}
+
+/* Everything short of the scalar multiplications. Nano signs with
+ * ed25519 using Blake2b-512 in place of SHA-512 */
+static bool sig_prepare(const nl_block_t *block, sig_prep_t *sig) {
+    crypto_generichash_blake2b_state state;
+    uint8_t digest[64];
+    uint256_t hash;
+
+    sig->r = block->signature;
+    sig->a = block->account;
+    memcpy(sig->s, &block->signature[32], sizeof(sig->s));
+    /* R and A aren't checked here: the scalar multiplications below
+     * reject encodings that aren't canonical points of the main subgroup */
+    if( !scalar_is_canonical(sig->s)
+            || E_SUCCESS != nanoparse_block_hash(block, hash) ) {
+        return false;
+    }
+
+    crypto_generichash_blake2b_init(&state, NULL, 0, sizeof(digest));
+    crypto_generichash_blake2b_update(&state, sig->r, 32);
+    crypto_generichash_blake2b_update(&state, sig->a, 32);
+    crypto_generichash_blake2b_update(&state, hash, sizeof(hash));
+    crypto_generichash_blake2b_final(&state, digest, sizeof(digest));
+    crypto_core_ed25519_scalar_reduce(sig->h, digest);
+    return true;
+}
+
+/* [s]B - [h]A == R, compared as encoded so a non-canonical R fails */
+static bool sig_check(const sig_prep_t *sig) {
+    uint8_t sb[32], ha[32], r[32];
+
+    if( 0 != crypto_scalarmult_ed25519_base_noclamp(sb, sig->s)
+            || 0 != crypto_scalarmult_ed25519_noclamp(ha, sig->h, sig->a)
+            || 0 != crypto_core_ed25519_sub(r, sb, ha) ) {
+        return false;
+    }
+    return 0 == sodium_memcmp(r, sig->r, sizeof(r));
+}
+
+/* acc += p; the first point added initializes acc */
+static bool point_accumulate(uint8_t acc[32], bool *have_acc, const uint8_t p[32]) {
+    if( !*have_acc ) {
+        memcpy(acc, p, 32);
+        *have_acc = true;
+        return true;
+    }
+    return 0 == crypto_core_ed25519_add(acc, acc, p);
+}
+
+/* With random 128-bit z_i, every signature in the batch is valid (with
+ * overwhelming probability) iff
+ *     [sum z_i s_i]B == sum [z_i]R_i + sum [z_i h_i]A_i
+ * The base point term costs one multiplication for the whole batch, and
+ * runs of blocks from the same account share one for their A term. */
+static bool sigs_check_batch(const sig_prep_t *sigs, size_t n) {
+    uint8_t z[32] = { 0 }, zx[32], point[32];
+    uint8_t sum_zs[32] = { 0 }, run_zh[32] = { 0 };
+    uint8_t lhs[32], rhs[32];
+    const uint8_t *run_a = NULL;
+    bool have_rhs = false;
+
+    for( size_t i = 0; i < n; i++ ) {
+        randombytes_buf(z, 16);
+        z[0] |= 1; // Never zero
+
+        crypto_core_ed25519_scalar_mul(zx, z, sigs[i].s);
+        crypto_core_ed25519_scalar_add(sum_zs, sum_zs, zx);
+
+        if( 0 != crypto_scalarmult_ed25519_noclamp(point, z, sigs[i].r)
+                || !point_accumulate(rhs, &have_rhs, point) ) {
+            return false;
+        }
+
+        crypto_core_ed25519_scalar_mul(zx, z, sigs[i].h);
+        if( NULL != run_a && 0 == memcmp(run_a, sigs[i].a, 32) ) {
+            crypto_core_ed25519_scalar_add(run_zh, run_zh, zx);
+            continue;
+        }
+        if( NULL != run_a && (0 != crypto_scalarmult_ed25519_noclamp(point, run_zh, run_a)
+                    || !point_accumulate(rhs, &have_rhs, point)) ) {
+            return false;
+        }
+        run_a = sigs[i].a;
+        memcpy(run_zh, zx, sizeof(run_zh));
+    }
+    if( NULL != run_a && (0 != crypto_scalarmult_ed25519_noclamp(point, run_zh, run_a)
+                || !point_accumulate(rhs, &have_rhs, point)) ) {
+        return false;
+    }
+
+    if( 0 != crypto_scalarmult_ed25519_base_noclamp(lhs, sum_zs) ) {
+        return false;
+    }
+    return 0 == sodium_memcmp(lhs, rhs, sizeof(lhs));
+}
+
+/* Verifies up to CONFIG_NANOPARSE_VERIFY_BATCH_LEN blocks; returns the
+ * number with bad signatures */
+static size_t verify_batch(const nl_block_t *blocks, size_t n, bool *valid) {
+    sig_prep_t sigs[CONFIG_NANOPARSE_VERIFY_BATCH_LEN];
+    uint8_t idx[CONFIG_NANOPARSE_VERIFY_BATCH_LEN];
+    bool ok[CONFIG_NANOPARSE_VERIFY_BATCH_LEN];
+    size_t n_sigs = 0, n_invalid = 0;
+
+    for( size_t i = 0; i < n; i++ ) {
+        ok[i] = sig_prepare(&blocks[i], &sigs[n_sigs]);
+        if( ok[i] ) {
+            idx[n_sigs++] = i;
+        }
+    }
+
+    /* A single signature is cheaper checked on its own, and a batch that
+     * fails is re-checked one by one to find the bad signatures */
+    if( 1 == n_sigs || (n_sigs > 1 && !sigs_check_batch(sigs, n_sigs)) ) {
+        for( size_t j = 0; j < n_sigs; j++ ) {
+            ok[idx[j]] = sig_check(&sigs[j]);
+        }
+    }
+
+    for( size_t i = 0; i < n; i++ ) {
+        n_invalid += !ok[i];
+        if( NULL != valid ) {
+            valid[i] = ok[i];
+        }
+    }
+    return n_invalid;
+}
+
+jolt_err_t nanoparse_block_verify(const nl_block_t *block) {
+    return 0 == verify_batch(block, 1, NULL) ? E_SUCCESS : E_FAILURE;
+}
+
+/* A worker's verify_batch frame plus libsodium's scalar multiplications */
+#define VERIFY_STACK_LEN (6144 + CONFIG_NANOPARSE_VERIFY_BATCH_LEN * (sizeof(sig_prep_t) + 2))
+
+typedef struct verify_pool_t {
+    const nl_block_t *blocks;
+    size_t n;
+    bool *valid;
+    size_t next;        // Atomic; first block of the next unclaimed batch
+    size_t n_invalid;   // Atomic
+} verify_pool_t;
+
+static void *verify_thread(void *arg) {
+    verify_pool_t *p = arg;
+    size_t i, n_invalid = 0;
+
+    while( (i = __atomic_fetch_add(&p->next, CONFIG_NANOPARSE_VERIFY_BATCH_LEN,
+                    __ATOMIC_RELAXED)) < p->n ) {
+        size_t len = p->n - i;
+        if( len > CONFIG_NANOPARSE_VERIFY_BATCH_LEN ) {
+            len = CONFIG_NANOPARSE_VERIFY_BATCH_LEN;
+        }
+        n_invalid += verify_batch(&p->blocks[i], len,
+                NULL == p->valid ? NULL : &p->valid[i]);
+    }
+    __atomic_add_fetch(&p->n_invalid, n_invalid, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+jolt_err_t nanoparse_blocks_verify(const nl_block_t *blocks, size_t n,
+        uint8_t n_threads, bool *valid) {
+    pthread_t threads[NANOPARSE_MAX_THREADS];
+    pthread_attr_t attr;
+    size_t n_batches = (n + CONFIG_NANOPARSE_VERIFY_BATCH_LEN - 1)
+            / CONFIG_NANOPARSE_VERIFY_BATCH_LEN;
+    uint8_t n_started = 0;
+    verify_pool_t p = { 0 };
+
+    p.blocks = blocks;
+    p.n = n;
+    p.valid = valid;
+    if( 0 == n_threads ) {
+        n_threads = CONFIG_NANOPARSE_VERIFY_THREADS;
+    }
+    if( 0 == n_threads ) {
+        n_threads = nanoparse_cores();
+    }
+    if( n_threads > NANOPARSE_MAX_THREADS ) {
+        n_threads = NANOPARSE_MAX_THREADS;
+    }
+    if( n_threads > n_batches ) {
+        n_threads = n_batches;
+    }
+
+    // The calling thread is one of the workers
+    nanoparse_thread_attr_init(&attr, VERIFY_STACK_LEN);
+    for( ; n_started + 1 < n_threads; n_started++ ) {
+        if( 0 != pthread_create(&threads[n_started], &attr, verify_thread, &p) ) {
+            break;
+        }
+    }
+    pthread_attr_destroy(&attr);
+    verify_thread(&p);
+    for( uint8_t i = 0; i < n_started; i++ ) {
+        pthread_join(threads[i], NULL);
+    }
+    return 0 == p.n_invalid ? E_SUCCESS : E_FAILURE;
+}
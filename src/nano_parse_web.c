@@ -3,16 +3,19 @@
  https://www.joltwallet.com/
  */
 
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sodium.h>
-#include "esp_log.h"
 #include "cJSON.h"
 
 #include "nano_lib.h"
 #include "jolttypes.h"
 #include "nano_parse.h"
+#include "nano_parse_hex.h"
+#include "nano_parse_log.h"
+#include "nano_parse_threads.h"
 
 #if CONFIG_NANOPARSE_BUILD_W_LWS || CONFIG_NANOPARSE_BUILD_W_REST
 
@@ -23,62 +26,502 @@
 #endif
 
 #define NANOPARSE_CMD_BUF_LEN 1024
-#define NANOPARSE_RX_BUF_LEN 1024
+
+/* Keeps accounts_frontiers replies within the largest pool buffer;
+ * pretty-printed entries are ~144 bytes each */
+#define NANOPARSE_FRONTIERS_ENTRY_LEN 144
+#define NANOPARSE_FRONTIERS_PER_REQUEST ((CONFIG_NANOPARSE_POOL_MAX_LEN - 64) \
+        / NANOPARSE_FRONTIERS_ENTRY_LEN)
+
+/* A pretty-printed accounts_pending account is ~80 bytes plus ~256 bytes per
+ * pending block with its source */
+#define NANOPARSE_PENDING_ACCOUNT_LEN 80
+#define NANOPARSE_PENDING_BLOCK_LEN 256
+
+/* A pretty-printed blocks_info entry is at most ~1KB; replies start in a
+ * buffer sized for the entries requested */
+#define NANOPARSE_BLOCKS_INFO_RX_BUF_LEN 8192
+#define NANOPARSE_BLOCKS_INFO_ENTRY_LEN 1024
+#define NANOPARSE_BLOCKS_PER_REQUEST ((NANOPARSE_BLOCKS_INFO_RX_BUF_LEN - 64) \
+        / NANOPARSE_BLOCKS_INFO_ENTRY_LEN)
+
+#if CONFIG_NANOPARSE_JSON_BLOCK
+#define NANOPARSE_JSON_BLOCK_ARG ",\"json_block\":\"true\""
+#else
+#define NANOPARSE_JSON_BLOCK_ARG ""
+#endif
 
 static const char TAG[] = "nano_parse";
 
+static nanoparse_block_cache_t *block_cache;
+
+/* nano_lws/nano_rest aren't reentrant, and nanoparse_web_work_race can
+ * leave a request running after it returns */
+static pthread_mutex_t web_transport_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int web_get_data(const char *cmd, char *rx, size_t len){
+    int res;
+
+    pthread_mutex_lock(&web_transport_lock);
+    res = network_get_data((char *)cmd, rx, len);
+    pthread_mutex_unlock(&web_transport_lock);
+    return res;
+}
+
+/* Sends cmd and receives the reply into a pooled buffer of at least
+ * min_len bytes; callers that can predict the reply size should pass it.
+ * network_get_data truncates silently, so a reply that fills the buffer
+ * is requested once more straight into the largest size class. Only for
+ * requests that are safe to repeat. */
+static jolt_err_t web_request_len(const char *cmd, nanoparse_buf_t *rx,
+        size_t min_len){
+    jolt_err_t res;
+
+    if( min_len > CONFIG_NANOPARSE_POOL_MAX_LEN ){
+        min_len = CONFIG_NANOPARSE_POOL_MAX_LEN;
+    }
+    res = nanoparse_pool_get(rx, min_len);
+    while( E_SUCCESS == res ){
+        rx->data[0] = '\0';
+        web_get_data(cmd, rx->data, rx->len);
+        if( strnlen(rx->data, rx->len) < rx->len - 1 ){
+            return E_SUCCESS;
+        }
+        if( rx->len >= CONFIG_NANOPARSE_POOL_MAX_LEN ){
+            NANOPARSE_LOGI(WEB, "reply doesn't fit in %u bytes",
+                    (unsigned int)rx->len);
+            res = E_INSUFFICIENT_BUF;
+            break;
+        }
+        NANOPARSE_LOGD(WEB, "reply filled %u bytes; retrying at %u",
+                (unsigned int)rx->len, (unsigned int)CONFIG_NANOPARSE_POOL_MAX_LEN);
+        nanoparse_pool_put(rx);
+        res = nanoparse_pool_get(rx, CONFIG_NANOPARSE_POOL_MAX_LEN);
+    }
+    nanoparse_pool_put(rx);
+    return res;
+}
+
+static jolt_err_t web_request(const char *cmd, nanoparse_buf_t *rx){
+    return web_request_len(cmd, rx, NANOPARSE_POOL_MIN_LEN);
+}
+
+/* Builds head, the quoted addresses (comma separated) and tail in a pooled
+ * buffer, for requests with more accounts than fit on the stack */
+static jolt_err_t web_accounts_cmd(nanoparse_buf_t *cmd, const char *head,
+        const char * const *addresses, size_t n, const char *tail){
+    size_t len = strlen(head) + strlen(tail) + 1;
+    jolt_err_t res;
+    char *p;
+
+    for( size_t i = 0; i < n; i++ ){
+        len += strlen(addresses[i]) + 3;
+    }
+    res = nanoparse_pool_get(cmd, len);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+    p = stpcpy(cmd->data, head);
+    for( size_t i = 0; i < n; i++ ){
+        if( i ){
+            *p++ = ',';
+        }
+        *p++ = '"';
+        p = stpcpy(p, addresses[i]);
+        *p++ = '"';
+    }
+    strcpy(p, tail);
+    return E_SUCCESS;
+}
+
+static jolt_err_t web_transport_submit(void *ctx, uint32_t id, const char *cmd){
+    nanoparse_web_transport_t *t = ctx;
+    uint8_t tail;
+
+    if( t->len >= CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT
+            || strlen(cmd) >= NANOPARSE_WEB_QUEUED_CMD_LEN ){
+        return E_INSUFFICIENT_BUF;
+    }
+    tail = (t->head + t->len) % CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT;
+    t->queue[tail].id = id;
+    strcpy(t->queue[tail].cmd, cmd);
+    t->len++;
+    return E_SUCCESS;
+}
+
+static jolt_err_t web_transport_poll(void *ctx, uint32_t *id, const char **reply){
+    nanoparse_web_transport_t *t = ctx;
+    jolt_err_t res;
+
+    // The previous reply has been parsed by now
+    nanoparse_pool_put(&t->reply);
+    if( 0 == t->len ){
+        return E_FAILURE;
+    }
+    res = web_request(t->queue[t->head].cmd, &t->reply);
+    *id = t->queue[t->head].id;
+    *reply = E_SUCCESS == res ? t->reply.data : "";
+    t->head = (t->head + 1) % CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT;
+    t->len--;
+    return E_SUCCESS;
+}
+
+static void web_transport_cancel(void *ctx, uint32_t id){
+    /* Drops the request if it hasn't been sent yet, keeping the rest in
+     * order */
+    nanoparse_web_transport_t *t = ctx;
+    uint8_t kept = 0;
+
+    for( uint8_t i = 0; i < t->len; i++ ){
+        uint8_t from = (t->head + i) % CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT;
+        uint8_t to = (t->head + kept) % CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT;
+        if( id == t->queue[from].id ){
+            continue;
+        }
+        if( from != to ){
+            t->queue[to] = t->queue[from];
+        }
+        kept++;
+    }
+    t->len = kept;
+}
+
+void nanoparse_web_transport_init(nanoparse_web_transport_t *t){
+    memset(t, 0, sizeof(nanoparse_web_transport_t));
+    t->transport.submit = web_transport_submit;
+    t->transport.poll = web_transport_poll;
+    t->transport.cancel = web_transport_cancel;
+    t->transport.ctx = t;
+}
+
+void nanoparse_web_transport_free(nanoparse_web_transport_t *t){
+    nanoparse_pool_put(&t->reply);
+    t->len = 0;
+}
+
+void nanoparse_web_set_block_cache(nanoparse_block_cache_t *cache){
+    block_cache = cache;
+}
 
 uint32_t nanoparse_web_block_count(){
     char rpc_command[NANOPARSE_CMD_BUF_LEN];
-    char rx_string[NANOPARSE_RX_BUF_LEN];
+    nanoparse_buf_t rx;
+    uint32_t count;
     
     snprintf( (char *) rpc_command, sizeof(rpc_command),
             "{\"action\":\"block_count\"}" );
-    network_get_data(rpc_command, rx_string, sizeof(rx_string));
-    return nanoparse_block_count(rx_string);
+    if( E_SUCCESS != web_request(rpc_command, &rx) ){
+        return 0;
+    }
+    count = nanoparse_block_count(rx.data);
+    nanoparse_pool_put(&rx);
+    return count;
 }
 
-jolt_err_t nanoparse_web_work(const hex256_t hash, uint64_t *work){
+static jolt_err_t web_work_remote(const hex256_t hash, uint64_t *work){
     char rpc_command[NANOPARSE_CMD_BUF_LEN];
-    char rx_string[NANOPARSE_RX_BUF_LEN];
+    nanoparse_buf_t rx;
+    jolt_err_t res;
+    uint256_t root;
    
     hex256_t hash_upper;
     strlcpy(hash_upper, hash, sizeof(hash_upper));
     strupr(hash_upper);
     snprintf( (char *) rpc_command, sizeof(rpc_command), "{\"action\":\"work_generate\",\"hash\":\"%s\"}", hash_upper );
-    network_get_data(rpc_command, rx_string, sizeof(rx_string));
+    res = web_request(rpc_command, &rx);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+    res = nanoparse_work(rx.data, work);
+    nanoparse_pool_put(&rx);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+
+    // Don't build on work the network will reject
+    if( E_SUCCESS != nanoparse_hex_decode(root, sizeof(root), hash, strlen(hash))
+            || nanoparse_work_value(root, *work) < NANOPARSE_WORK_THRESHOLD ){
+        NANOPARSE_LOGI(WEB, "nanoparse_web_work: node returned invalid work");
+        return E_FAILURE;
+    }
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_web_work(const hex256_t hash, uint64_t *work){
+    jolt_err_t res;
 
-    return nanoparse_work(rx_string, work);
+    res = web_work_remote(hash, work);
+#if CONFIG_NANOPARSE_WORK_LOCAL_FALLBACK
+    if( E_SUCCESS != res ){
+        NANOPARSE_LOGI(WEB, "nanoparse_web_work: generating locally");
+        res = nanoparse_work_local(hash, work);
+    }
+#endif
+    return res;
+}
+
+/* Shared by nanoparse_web_work_race and its remote thread; whichever is
+ * done with it last frees it, since the remote request can't be aborted */
+typedef struct work_race_t {
+    hex256_t hash;
+    uint64_t work;
+    volatile bool remote_done; // Remote work is valid; cancels the search
+    int refs;                  // Atomic
+} work_race_t;
+
+/* rpc_command plus the HTTP/TLS client underneath network_get_data */
+#define WORK_RACE_STACK_LEN (NANOPARSE_CMD_BUF_LEN + 8192)
+
+static void work_race_release(work_race_t *race){
+    if( 0 == __atomic_sub_fetch(&race->refs, 1, __ATOMIC_ACQ_REL) ){
+        free(race);
+    }
+}
+
+static void *work_race_remote(void *arg){
+    work_race_t *race = arg;
+    uint64_t work;
+
+    if( E_SUCCESS == web_work_remote(race->hash, &work) ){
+        race->work = work;
+        __atomic_store_n(&race->remote_done, true, __ATOMIC_RELEASE);
+    }
+    work_race_release(race);
+    return NULL;
+}
+
+jolt_err_t nanoparse_web_work_race(const hex256_t hash, uint64_t *work){
+    nanoparse_work_opts_t opts = { 0 };
+    pthread_attr_t attr;
+    pthread_t thread;
+    work_race_t *race;
+    uint256_t root;
+    jolt_err_t res;
+
+    if( E_SUCCESS != nanoparse_hex_decode(root, sizeof(root), hash, strlen(hash)) ){
+        return E_FAILURE;
+    }
+
+    race = calloc(1, sizeof(work_race_t));
+    if( NULL == race ){
+        return nanoparse_work_generate(root, NULL, work, NULL);
+    }
+    strlcpy(race->hash, hash, sizeof(race->hash));
+    race->refs = 2;
+
+    nanoparse_thread_attr_init(&attr, WORK_RACE_STACK_LEN);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if( 0 != pthread_create(&thread, &attr, work_race_remote, race) ){
+        race->refs = 1;
+    }
+    pthread_attr_destroy(&attr);
+
+    opts.cancel = &race->remote_done;
+    res = nanoparse_work_generate(root, &opts, work, NULL);
+    if( E_SUCCESS != res && __atomic_load_n(&race->remote_done, __ATOMIC_ACQUIRE) ){
+        *work = race->work;
+        res = E_SUCCESS;
+    }
+    work_race_release(race);
+    return res;
 }
 
 jolt_err_t nanoparse_web_account_frontier(const char *account_address, hex256_t frontier_block_hash){
     char rpc_command[NANOPARSE_CMD_BUF_LEN];
-    char rx_string[NANOPARSE_RX_BUF_LEN];
+    nanoparse_buf_t rx;
+    jolt_err_t res;
     
     snprintf( (char *) rpc_command, sizeof(rpc_command),
             "{\"action\":\"accounts_frontiers\",\"accounts\":[\"%s\"]}",
             account_address);
-    network_get_data(rpc_command, rx_string, sizeof(rx_string));
+    res = web_request(rpc_command, &rx);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+    res = nanoparse_account_frontier(rx.data, frontier_block_hash);
+    nanoparse_pool_put(&rx);
+    return res;
+}
 
-    return nanoparse_account_frontier(rx_string, frontier_block_hash);
+jolt_err_t nanoparse_web_account_info(const char *account_address,
+        nanoparse_account_info_t *info){
+    char rpc_command[NANOPARSE_CMD_BUF_LEN];
+    nanoparse_buf_t rx;
+    jolt_err_t res;
+
+    snprintf( (char *) rpc_command, sizeof(rpc_command),
+            "{\"action\":\"account_info\",\"representative\":\"true\","
+            "\"account\":\"%s\"}",
+            account_address);
+    res = web_request(rpc_command, &rx);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+    res = nanoparse_account_info(rx.data, info);
+    nanoparse_pool_put(&rx);
+    return res;
+}
+
+jolt_err_t nanoparse_web_account_balance(const char *account_address,
+        nanoparse_account_balance_t *balance){
+    char rpc_command[NANOPARSE_CMD_BUF_LEN];
+    nanoparse_buf_t rx;
+    jolt_err_t res;
+
+    snprintf( (char *) rpc_command, sizeof(rpc_command),
+            "{\"action\":\"account_balance\",\"account\":\"%s\"}",
+            account_address);
+    res = web_request(rpc_command, &rx);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+    res = nanoparse_account_balance(rx.data, balance);
+    nanoparse_pool_put(&rx);
+    return res;
+}
+
+jolt_err_t nanoparse_web_account_frontiers(const char * const *account_addresses,
+        size_t n_accounts, nanoparse_frontier_t *frontiers, size_t *n_frontiers){
+    /* Requests the frontiers in chunks that fit the largest receive buffer */
+    nanoparse_buf_t cmd, rx;
+    jolt_err_t res;
+
+    *n_frontiers = 0;
+    for( size_t i = 0; i < n_accounts; i += NANOPARSE_FRONTIERS_PER_REQUEST ) {
+        size_t n_chunk = n_accounts - i;
+        size_t n_parsed;
+
+        if( n_chunk > NANOPARSE_FRONTIERS_PER_REQUEST ) {
+            n_chunk = NANOPARSE_FRONTIERS_PER_REQUEST;
+        }
+
+        res = web_accounts_cmd(&cmd, "{\"action\":\"accounts_frontiers\",\"accounts\":[",
+                &account_addresses[i], n_chunk, "]}");
+        if( E_SUCCESS != res ) {
+            return res;
+        }
+        res = web_request_len(cmd.data, &rx,
+                64 + n_chunk * NANOPARSE_FRONTIERS_ENTRY_LEN);
+        nanoparse_pool_put(&cmd);
+        if( E_SUCCESS != res ) {
+            return res;
+        }
+        res = nanoparse_account_frontiers(rx.data, &frontiers[*n_frontiers],
+                n_accounts - *n_frontiers, &n_parsed);
+        nanoparse_pool_put(&rx);
+        *n_frontiers += n_parsed;
+        if( E_SUCCESS != res ) {
+            return res;
+        }
+    }
+    return E_SUCCESS;
 }
 
 jolt_err_t nanoparse_web_block(const hex256_t block_hash, nl_block_t *block){
     char rpc_command[NANOPARSE_CMD_BUF_LEN];
-    char rx_string[NANOPARSE_RX_BUF_LEN];
+    nanoparse_buf_t rx;
+    uint256_t hash, computed;
+    jolt_err_t res;
+
+    if( E_SUCCESS != nanoparse_hex_decode(hash, sizeof(hash),
+                block_hash, strlen(block_hash)) ){
+        return E_FAILURE;
+    }
+    if( NULL != block_cache
+            && E_SUCCESS == nanoparse_block_cache_get(block_cache, hash, block) ){
+        return E_SUCCESS;
+    }
 
     snprintf( (char *) rpc_command, sizeof(rpc_command),
-             "{\"action\":\"block\",\"hash\":\"%s\"}",
+             "{\"action\":\"block\",\"hash\":\"%s\"" NANOPARSE_JSON_BLOCK_ARG "}",
              block_hash);
-    network_get_data(rpc_command, rx_string, sizeof(rx_string));
+    res = web_request(rpc_command, &rx);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+    res = nanoparse_block_and_hash(rx.data, block, computed);
+    nanoparse_pool_put(&rx);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+    // The node must return the block that was asked for
+    if( 0 != memcmp(hash, computed, sizeof(hash)) ){
+        NANOPARSE_LOGW(WEB, "nanoparse_web_block: contents don't match %s",
+                block_hash);
+        return E_FAILURE;
+    }
+    if( NULL != block_cache ){
+        nanoparse_block_cache_put(block_cache, hash, block);
+    }
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_web_blocks_info(const uint256_t *hashes, size_t n_hashes,
+        nl_block_t *blocks){
+    char rpc_command[NANOPARSE_CMD_BUF_LEN];
+    nanoparse_buf_t rx;
+    jolt_err_t res = E_SUCCESS;
+
+    for( size_t i = 0; i < n_hashes; i += NANOPARSE_BLOCKS_PER_REQUEST ) {
+        size_t n_chunk = n_hashes - i;
+        hex256_t hash;
+        int len;
+
+        if( n_chunk > NANOPARSE_BLOCKS_PER_REQUEST ) {
+            n_chunk = NANOPARSE_BLOCKS_PER_REQUEST;
+        }
 
-    return nanoparse_block(rx_string, block);
+        len = snprintf( (char *) rpc_command, sizeof(rpc_command),
+                "{\"action\":\"blocks_info\"" NANOPARSE_JSON_BLOCK_ARG ",\"hashes\":[");
+        for( size_t j = 0; j < n_chunk && len < sizeof(rpc_command); j++ ) {
+            nanoparse_hex_encode(hash, hashes[i + j], sizeof(uint256_t), true);
+            len += snprintf( (char *) rpc_command + len, sizeof(rpc_command) - len,
+                    "%s\"%s\"", j ? "," : "", hash);
+        }
+        if( len < sizeof(rpc_command) ) {
+            len += snprintf( (char *) rpc_command + len, sizeof(rpc_command) - len, "]}");
+        }
+        if( len >= sizeof(rpc_command) ) {
+            res = E_INSUFFICIENT_BUF;
+            break;
+        }
+
+        res = web_request_len(rpc_command, &rx,
+                64 + n_chunk * NANOPARSE_BLOCKS_INFO_ENTRY_LEN);
+        if( E_SUCCESS != res ) {
+            break;
+        }
+        res = nanoparse_blocks_info(rx.data, &hashes[i], n_chunk, &blocks[i]);
+        nanoparse_pool_put(&rx);
+        if( E_SUCCESS != res ) {
+            break;
+        }
+        for( size_t j = 0; j < n_chunk; j++ ) {
+            uint256_t computed;
+            if( E_SUCCESS != nanoparse_block_hash(&blocks[i + j], computed)
+                    || 0 != memcmp(hashes[i + j], computed, sizeof(computed)) ) {
+                NANOPARSE_LOGW(WEB, "nanoparse_web_blocks_info: contents "
+                        "don't match the requested hash");
+                res = E_FAILURE;
+                break;
+            }
+        }
+        if( E_SUCCESS != res ) {
+            break;
+        }
+        for( size_t j = 0; NULL != block_cache && j < n_chunk; j++ ) {
+            nanoparse_block_cache_put(block_cache, hashes[i + j], &blocks[i + j]);
+        }
+    }
+
+    return res;
 }
 
 jolt_err_t nanoparse_web_pending_hash( const char *account_address,
         hex256_t pending_block_hash, mbedtls_mpi *amount){
     char rpc_command[NANOPARSE_CMD_BUF_LEN];
-    char rx_string[NANOPARSE_RX_BUF_LEN];
+    nanoparse_buf_t rx;
+    jolt_err_t res;
     
     snprintf( (char *) rpc_command, sizeof(rpc_command),
              "{\"action\":\"accounts_pending\","
@@ -86,9 +529,60 @@ jolt_err_t nanoparse_web_pending_hash( const char *account_address,
              "\"source\": \"true\","
              "\"accounts\":[\"%s\"]}",
              account_address);
-    network_get_data(rpc_command, rx_string, sizeof(rx_string));
+    res = web_request(rpc_command, &rx);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+    res = nanoparse_pending_hash(rx.data, pending_block_hash, amount);
+    nanoparse_pool_put(&rx);
+    return res;
+}
+
+jolt_err_t nanoparse_web_accounts_pending(const char * const *account_addresses,
+        size_t n_accounts, uint32_t count, nanoparse_pending_cb_t cb, void *ctx){
+    /* Requests the accounts in chunks whose replies fit the largest receive
+     * buffer; every chunk feeds the same cb */
+    char head[96];
+    size_t per_account, per_request;
+    nanoparse_buf_t cmd, rx;
+    jolt_err_t res = E_SUCCESS;
+
+    per_account = NANOPARSE_PENDING_ACCOUNT_LEN
+            + (count ? count : 1) * NANOPARSE_PENDING_BLOCK_LEN;
+    per_request = (CONFIG_NANOPARSE_POOL_MAX_LEN - 64) / per_account;
+    if( 0 == per_request ) {
+        per_request = 1;
+    }
+    snprintf(head, sizeof(head),
+             "{\"action\":\"accounts_pending\","
+             "\"count\": %u,"
+             "\"source\": \"true\","
+             "\"accounts\":[", (unsigned int)count);
+
+    for( size_t i = 0; i < n_accounts; i += per_request ) {
+        size_t n_chunk = n_accounts - i;
+
+        if( n_chunk > per_request ) {
+            n_chunk = per_request;
+        }
 
-    return nanoparse_pending_hash(rx_string, pending_block_hash, amount);
+        res = web_accounts_cmd(&cmd, head, &account_addresses[i], n_chunk, "]}");
+        if( E_SUCCESS != res ) {
+            break;
+        }
+        res = web_request_len(cmd.data, &rx, 64 + n_chunk * per_account);
+        nanoparse_pool_put(&cmd);
+        if( E_SUCCESS != res ) {
+            break;
+        }
+        res = nanoparse_accounts_pending(rx.data, cb, ctx);
+        nanoparse_pool_put(&rx);
+        if( E_SUCCESS != res ) {
+            break;
+        }
+    }
+
+    return res;
 }
 
 jolt_err_t nanoparse_web_frontier_block(nl_block_t *block){
@@ -110,7 +604,7 @@ jolt_err_t nanoparse_web_frontier_block(nl_block_t *block){
         return res;
     }
 
-    ESP_LOGI(TAG, "frontier_block: Address: %s\n", address);
+    NANOPARSE_LOGV(WEB, "frontier_block: Address: %s\n", address);
     
     /* Get latest block from server */
     // First get frontier block hash
@@ -119,22 +613,53 @@ jolt_err_t nanoparse_web_frontier_block(nl_block_t *block){
     if( E_SUCCESS != res ){
         return res;
     }
-    ESP_LOGI(TAG, "frontier_block: Frontier Block: %s", frontier_block_hash);
+    NANOPARSE_LOGV(WEB, "frontier_block: Frontier Block: %s", frontier_block_hash);
     
     // Now get the block contents
     return nanoparse_web_block(frontier_block_hash, block);
 }
 
+jolt_err_t nanoparse_web_next_block(nl_block_t *block){
+    char rpc_command[NANOPARSE_CMD_BUF_LEN];
+    nanoparse_buf_t rx;
+    char address[ADDRESS_BUF_LEN];
+    jolt_err_t res;
+
+    res = nl_public_to_address(address, sizeof(address), block->account);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+
+    snprintf( (char *) rpc_command, sizeof(rpc_command),
+            "{\"action\":\"account_info\",\"representative\":\"true\","
+            "\"account\":\"%s\"}",
+            address);
+    res = web_request(rpc_command, &rx);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+    res = nanoparse_next_block(rx.data, block);
+    nanoparse_pool_put(&rx);
+    return res;
+}
+
 jolt_err_t nanoparse_web_process(nl_block_t *block){
     jolt_err_t res;
     char rpc_command[NANOPARSE_CMD_BUF_LEN];
-    char rx_string[NANOPARSE_RX_BUF_LEN];
+    nanoparse_buf_t rx;
 
     res = nanoparse_process(block, rpc_command, sizeof(rpc_command));
     if( E_SUCCESS != res ){
         return res;
     }
-    return network_get_data(rpc_command, rx_string, sizeof(rx_string));
+    // Not repeated on truncation; publishing twice isn't harmless
+    res = nanoparse_pool_get(&rx, NANOPARSE_POOL_MIN_LEN);
+    if( E_SUCCESS != res ){
+        return res;
+    }
+    res = web_get_data(rpc_command, rx.data, rx.len);
+    nanoparse_pool_put(&rx);
+    return res;
 }
 
 #endif
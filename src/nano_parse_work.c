@@ -0,0 +1,340 @@
+/* nano_lib - ESP32 Any functions related to seed/private keys for Nano
+ Copyright (C) 2018  Brian Pugh, James Coxon, Michael Smaili
+ https://www.joltwallet.com/
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sodium.h>
+
+#include "nano_lib.h"
+#include "jolttypes.h"
+#include "nano_parse.h"
+#include "nano_parse_hex.h"
+#include "nano_parse_threads.h"
+
+#if !defined(__GNUC__)
+#error "nano_parse_work.c uses GCC vector extensions"
+#endif
+
+/* Nonces hashed side by side. GCC lowers the vector type to SSE/AVX/NEON
+ * where the target has it and to plain 64-bit ops elsewhere (e.g. Xtensa) */
+#define WORK_LANES 4
+typedef uint64_t lane_t __attribute__((vector_size(8 * WORK_LANES)));
+
+/* Nonces per lane between checks for a result or cancellation */
+#define WORK_BATCH 256
+
+/* The 4-lane Blake2b state and message are ~1.5KB; the rest is headroom */
+#define WORK_STACK_LEN 4096
+
+static const uint64_t blake2b_iv[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
+    0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+    0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+};
+
+static const uint8_t blake2b_sigma[12][16] = {
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+    { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+    {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+    {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+    {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+    { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+    { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+    {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+    { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 },
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+};
+
+/* Parameter block word 0 for an unkeyed 8-byte digest */
+#define WORK_PARAM0 0x01010008ULL
+/* nonce (8) || root (32) */
+#define WORK_MSG_LEN 40
+
+#define ROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+#define G(r, i, a, b, c, d) do { \
+    a = a + b + m[blake2b_sigma[r][2 * (i)]]; \
+    d = ROTR64(d ^ a, 32); \
+    c = c + d; \
+    b = ROTR64(b ^ c, 24); \
+    a = a + b + m[blake2b_sigma[r][2 * (i) + 1]]; \
+    d = ROTR64(d ^ a, 16); \
+    c = c + d; \
+    b = ROTR64(b ^ c, 63); \
+} while(0)
+
+static uint64_t load64_le(const uint8_t *p) {
+    uint64_t x = 0;
+    for( int8_t i = 7; i >= 0; i-- ) {
+        x = (x << 8) | p[i];
+    }
+    return x;
+}
+
+/* Blake2b with an 8-byte digest of nonce || root, read as a little-endian
+ * uint64, for WORK_LANES (nonce, root) pairs at once. The whole message fits
+ * in one compression, so this is that compression specialised to the layout. */
+static void work_value_lanes(lane_t *value, const lane_t root[4],
+        const lane_t *nonce) {
+    const lane_t zero = { 0 };
+    lane_t m[16], v[16];
+
+    m[0] = *nonce;
+    for( uint8_t i = 1; i < 16; i++ ) {
+        m[i] = i <= 4 ? root[i - 1] : zero;
+    }
+    for( uint8_t i = 0; i < 8; i++ ) {
+        v[i] = zero + blake2b_iv[i];
+        v[i + 8] = zero + blake2b_iv[i];
+    }
+    v[0] ^= WORK_PARAM0;
+    v[12] ^= WORK_MSG_LEN;
+    v[14] = ~v[14]; // Last block
+
+    for( uint8_t r = 0; r < 12; r++ ) {
+        G(r, 0, v[0], v[4], v[ 8], v[12]);
+        G(r, 1, v[1], v[5], v[ 9], v[13]);
+        G(r, 2, v[2], v[6], v[10], v[14]);
+        G(r, 3, v[3], v[7], v[11], v[15]);
+        G(r, 4, v[0], v[5], v[10], v[15]);
+        G(r, 5, v[1], v[6], v[11], v[12]);
+        G(r, 6, v[2], v[7], v[ 8], v[13]);
+        G(r, 7, v[3], v[4], v[ 9], v[14]);
+    }
+    *value = (blake2b_iv[0] ^ WORK_PARAM0) ^ v[0] ^ v[8];
+}
+
+/* Same root in every lane */
+static void work_root_words(lane_t words[4], const uint256_t root) {
+    const lane_t zero = { 0 };
+    for( uint8_t i = 0; i < 4; i++ ) {
+        words[i] = zero + load64_le(&root[8 * i]);
+    }
+}
+
+uint64_t nanoparse_work_value(const uint256_t root, uint64_t work) {
+    const lane_t zero = { 0 };
+    lane_t nonce = zero + work;
+    lane_t value;
+    lane_t words[4];
+
+    work_root_words(words, root);
+    work_value_lanes(&value, words, &nonce);
+    return value[0];
+}
+
+/* Checks up to WORK_LANES pairs in one pass; unused lanes repeat lane 0.
+ * Returns the number that fall below threshold */
+static size_t work_check_lanes(const uint8_t *roots[WORK_LANES],
+        const uint64_t works[WORK_LANES], uint8_t n, uint64_t threshold,
+        bool *valid) {
+    lane_t words[4], nonces, values;
+    size_t n_invalid = 0;
+
+    for( uint8_t l = 0; l < WORK_LANES; l++ ) {
+        uint8_t src = l < n ? l : 0;
+        for( uint8_t i = 0; i < 4; i++ ) {
+            words[i][l] = load64_le(&roots[src][8 * i]);
+        }
+        nonces[l] = works[src];
+    }
+    work_value_lanes(&values, words, &nonces);
+    for( uint8_t l = 0; l < n; l++ ) {
+        bool ok = values[l] >= threshold;
+        if( NULL != valid ) {
+            valid[l] = ok;
+        }
+        n_invalid += !ok;
+    }
+    return n_invalid;
+}
+
+jolt_err_t nanoparse_work_validate(const uint256_t *roots,
+        const uint64_t *works, size_t n, uint64_t threshold, bool *valid) {
+    const uint8_t *lane_roots[WORK_LANES];
+    size_t n_invalid = 0;
+
+    if( 0 == threshold ) {
+        threshold = NANOPARSE_WORK_THRESHOLD;
+    }
+    for( size_t i = 0; i < n; i += WORK_LANES ) {
+        uint8_t batch = n - i < WORK_LANES ? n - i : WORK_LANES;
+        for( uint8_t l = 0; l < batch; l++ ) {
+            lane_roots[l] = roots[i + l];
+        }
+        n_invalid += work_check_lanes(lane_roots, &works[i], batch, threshold,
+                NULL == valid ? NULL : &valid[i]);
+    }
+    return 0 == n_invalid ? E_SUCCESS : E_FAILURE;
+}
+
+/* Legacy open blocks don't carry a previous, so an nl_block_t reused
+ * across parses may still hold another block's */
+static const uint8_t *block_root(const nl_block_t *block) {
+    static const uint256_t zero = { 0 };
+    if( OPEN == block->type || (STATE == block->type
+                && 0 == memcmp(block->previous, zero, sizeof(zero))) ) {
+        return block->account;
+    }
+    return block->previous;
+}
+
+void nanoparse_block_root(const nl_block_t *block, uint256_t root) {
+    memcpy(root, block_root(block), sizeof(uint256_t));
+}
+
+jolt_err_t nanoparse_blocks_work_validate(const nl_block_t *blocks, size_t n,
+        uint64_t threshold, bool *valid) {
+    const uint8_t *lane_roots[WORK_LANES];
+    uint64_t lane_works[WORK_LANES];
+    size_t n_invalid = 0;
+
+    if( 0 == threshold ) {
+        threshold = NANOPARSE_WORK_THRESHOLD;
+    }
+    for( size_t i = 0; i < n; i += WORK_LANES ) {
+        uint8_t batch = n - i < WORK_LANES ? n - i : WORK_LANES;
+        for( uint8_t l = 0; l < batch; l++ ) {
+            lane_roots[l] = block_root(&blocks[i + l]);
+            lane_works[l] = blocks[i + l].work;
+        }
+        n_invalid += work_check_lanes(lane_roots, lane_works, batch, threshold,
+                NULL == valid ? NULL : &valid[i]);
+    }
+    return 0 == n_invalid ? E_SUCCESS : E_FAILURE;
+}
+
+typedef struct work_search_t {
+    lane_t root[4];
+    uint64_t threshold;
+    const volatile bool *cancel;
+    int found;          // Atomic; first thread to set it owns work
+    uint64_t work;
+    uint64_t hashes;    // Atomic
+} work_search_t;
+
+static void *work_thread(void *arg) {
+    work_search_t *s = arg;
+    lane_t offsets;
+    uint64_t nonce;
+    uint64_t n = 0;
+
+    for( uint8_t l = 0; l < WORK_LANES; l++ ) {
+        offsets[l] = l;
+    }
+    // Random starting points keep threads (and devices) from overlapping
+    randombytes_buf(&nonce, sizeof(nonce));
+
+    while( !__atomic_load_n(&s->found, __ATOMIC_RELAXED)
+            && !(NULL != s->cancel && *s->cancel) ) {
+        for( uint16_t i = 0; i < WORK_BATCH; i++ ) {
+            lane_t nonces = offsets + nonce;
+            lane_t values;
+            work_value_lanes(&values, s->root, &nonces);
+            nonce += WORK_LANES;
+            for( uint8_t l = 0; l < WORK_LANES; l++ ) {
+                int expected = 0;
+                if( values[l] >= s->threshold
+                        && __atomic_compare_exchange_n(&s->found, &expected, 1,
+                            false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED) ) {
+                    s->work = nonces[l];
+                    n += (i + 1) * WORK_LANES;
+                    goto exit;
+                }
+            }
+        }
+        n += WORK_BATCH * WORK_LANES;
+    }
+
+    exit:
+        __atomic_add_fetch(&s->hashes, n, __ATOMIC_RELAXED);
+        return NULL;
+}
+
+uint8_t nanoparse_cores(void) {
+#if defined(__linux__) || defined(__APPLE__)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n < 1 ? 1 : (n > NANOPARSE_MAX_THREADS ? NANOPARSE_MAX_THREADS : n);
+#elif CONFIG_FREERTOS_UNICORE
+    return 1;
+#else
+    return 2;
+#endif
+}
+
+void nanoparse_thread_attr_init(pthread_attr_t *attr, size_t stack_len) {
+#ifdef PTHREAD_STACK_MIN
+    if( stack_len < PTHREAD_STACK_MIN ) {
+        stack_len = PTHREAD_STACK_MIN;
+    }
+#endif
+    pthread_attr_init(attr);
+    pthread_attr_setstacksize(attr, stack_len);
+}
+
+jolt_err_t nanoparse_work_generate(const uint256_t root,
+        const nanoparse_work_opts_t *opts, uint64_t *work, uint64_t *hashes) {
+    pthread_t threads[NANOPARSE_MAX_THREADS];
+    pthread_attr_t attr;
+    uint8_t n_threads = CONFIG_NANOPARSE_WORK_THREADS;
+    uint8_t n_started = 0;
+    work_search_t s = { 0 };
+
+    work_root_words(s.root, root);
+    s.threshold = NANOPARSE_WORK_THRESHOLD;
+    if( NULL != opts ) {
+        if( 0 != opts->threshold ) {
+            s.threshold = opts->threshold;
+        }
+        if( 0 != opts->n_threads ) {
+            n_threads = opts->n_threads;
+        }
+        s.cancel = opts->cancel;
+    }
+    if( 0 == n_threads ) {
+        n_threads = nanoparse_cores();
+    }
+    if( n_threads > NANOPARSE_MAX_THREADS ) {
+        n_threads = NANOPARSE_MAX_THREADS;
+    }
+
+    // The calling thread is one of the workers
+    nanoparse_thread_attr_init(&attr, WORK_STACK_LEN);
+    for( ; n_started + 1 < n_threads; n_started++ ) {
+        if( 0 != pthread_create(&threads[n_started], &attr, work_thread, &s) ) {
+            break;
+        }
+    }
+    pthread_attr_destroy(&attr);
+    work_thread(&s);
+    for( uint8_t i = 0; i < n_started; i++ ) {
+        pthread_join(threads[i], NULL);
+    }
+
+    if( NULL != hashes ) {
+        *hashes = s.hashes;
+    }
+    if( !s.found ) {
+        return E_FAILURE;
+    }
+    *work = s.work;
+    return E_SUCCESS;
+}
+
+jolt_err_t nanoparse_work_local(const hex256_t hash, uint64_t *work) {
+    uint256_t root;
+
+    if( E_SUCCESS != nanoparse_hex_decode(root, sizeof(root), hash, strlen(hash)) ) {
+        return E_FAILURE;
+    }
+    return nanoparse_work_generate(root, NULL, work, NULL);
+}
@@ -283,6 +283,95 @@ TEST_CASE("Parse State Block (json string)", TEST_TAG){
     nl_block_free( &pred );
 }
 
+static void state_block_gt(nl_block_t *gt){
+    /* Ground truth shared by the state block tests below */
+    nl_block_init( gt );
+
+    gt->type = STATE;
+    nl_address_to_public(gt->account, "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb");
+    sodium_hex2bin(gt->previous, sizeof(gt->previous),
+            "6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655",
+            HEX_256, NULL, NULL, NULL);
+    nl_address_to_public(gt->representative, "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb");
+    nl_parse_server_work_string("6aa2c8a6e053c0d4", &(gt->work));
+    sodium_hex2bin(gt->signature, sizeof(gt->signature),
+            "A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E"
+            "9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904",
+            HEX_512, NULL, NULL, NULL);
+    sodium_hex2bin(gt->link, sizeof(gt->link),
+            "5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056",
+            HEX_256, NULL, NULL, NULL);
+    mbedtls_mpi_read_string(&(gt->balance), 10, "0");
+}
+
+TEST_CASE("Parse State Block (reordered keys)", TEST_TAG){
+    /* "type" last, plus unrelated compound members that must be skipped */
+    jolt_err_t res;
+    const char *json_data = "{\"work\": \"6aa2c8a6e053c0d4\", \"extra\": {\"a\": [1, {\"b\": \"}\"}]}, \"account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\", \"previous\": \"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\", \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\", \"balance\": \"0\", \"link\": \"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\", \"signature\": \"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\", \"type\": \"state\"}";
+
+    // Setup Test Vector
+    nl_block_t gt;
+    state_block_gt( &gt );
+
+    // Test Parser
+    nl_block_t pred;
+    nl_block_init( &pred );
+    res =  nanoparse_block(json_data, &pred);
+
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(nl_block_equal(&(gt), &(pred)));
+
+    ESP_ERROR_CHECK( !heap_caps_check_integrity_all(0) );
+
+    nl_block_free( &gt );
+    nl_block_free( &pred );
+}
+
+TEST_CASE("Parse State Block (escaped contents)", TEST_TAG){
+    /* Nested string values with their own escapes, CRLF and tabs */
+    jolt_err_t res;
+    const char *json_data = "{\"contents\": \"{\\r\\n\\t\\\"note\\\": \\\"a \\\\\\\"quoted\\\\\\\" \\\\\\\\ value\\\",\\r\\n\\t\\\"t\\\\u0079pe\\\": \\\"state\\\", \\\"account\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\", \\\"previous\\\": \\\"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\\\", \\\"representative\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\", \\\"balance\\\": \\\"0\\\", \\\"link\\\": \\\"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\\\", \\\"signature\\\": \\\"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\\\", \\\"work\\\": \\\"6aa2c8a6e053c0d4\\\"}\"}";
+
+    // Setup Test Vector
+    nl_block_t gt;
+    state_block_gt( &gt );
+
+    // Test Parser
+    nl_block_t pred;
+    nl_block_init( &pred );
+    res =  nanoparse_block(json_data, &pred);
+
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(nl_block_equal(&(gt), &(pred)));
+
+    ESP_ERROR_CHECK( !heap_caps_check_integrity_all(0) );
+
+    nl_block_free( &gt );
+    nl_block_free( &pred );
+}
+
+TEST_CASE("Parse State Block (json_block response)", TEST_TAG){
+    jolt_err_t res;
+    const char *json_data = "{\n    \"contents\": {\n        \"type\": \"state\",\n        \"account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\",\n        \"previous\": \"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\",\n        \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\",\n        \"balance\": \"0\",\n        \"link\": \"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\",\n        \"link_as_account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\",\n        \"signature\": \"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\",\n        \"work\": \"6aa2c8a6e053c0d4\"\n    }\n}\n";
+
+    // Setup Test Vector
+    nl_block_t gt;
+    state_block_gt( &gt );
+
+    // Test Parser
+    nl_block_t pred;
+    nl_block_init( &pred );
+    res =  nanoparse_block(json_data, &pred);
+
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(nl_block_equal(&(gt), &(pred)));
+
+    ESP_ERROR_CHECK( !heap_caps_check_integrity_all(0) );
+
+    nl_block_free( &gt );
+    nl_block_free( &pred );
+}
+
 TEST_CASE("Parse Malformed (no work)", TEST_TAG){
     jolt_err_t res;
     const char *json_data = "{\n    \"contents\": \"{\\n    \\\"type\\\": \\\"state\\\",\\n    \\\"account\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n    \\\"previous\\\": \\\"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\\\",\\n    \\\"representative\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n    \\\"balance\\\": \\\"0\\\",\\n    \\\"link\\\": \\\"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\\\",\\n    \\\"link_as_account\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n    \\\"signature\\\": \\\"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\\\",\\n \\n}\\n\"\n}\n";
@@ -297,6 +386,20 @@ TEST_CASE("Parse Malformed (no work)", TEST_TAG){
     nl_block_free( &pred );
 }
 
+TEST_CASE("Parse Malformed (bad hex)", TEST_TAG){
+    jolt_err_t res;
+    const char *json_data = "{\"contents\": {\"type\": \"state\", \"account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\", \"previous\": \"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA65G\", \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\", \"balance\": \"0\", \"link\": \"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\", \"signature\": \"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\", \"work\": \"6aa2c8a6e053c0d4\"}}";
+
+    // Test Parser
+    nl_block_t pred;
+    nl_block_init( &pred );
+    res =  nanoparse_block(json_data, &pred);
+
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+
+    nl_block_free( &pred );
+}
+
 TEST_CASE("Pending Hash and Amount", TEST_TAG){
     jolt_err_t res;
     hex256_t pending_hash;
@@ -310,3 +413,1088 @@ TEST_CASE("Pending Hash and Amount", TEST_TAG){
 
     mbedtls_mpi_free( &amount );
 }
+
+TEST_CASE("Process Command Round Trip", TEST_TAG){
+    /* The generated "block" member must parse back to the same block */
+    jolt_err_t res;
+    char buf[1024];
+
+    nl_block_t gt;
+    state_block_gt( &gt );
+    mbedtls_mpi_read_string(&(gt.balance), 10, "40200000001000000000000000000000000");
+
+    res = nanoparse_process(&gt, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+
+    nl_block_t pred;
+    nl_block_init( &pred );
+    res = nanoparse_block(buf, &pred);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(nl_block_equal(&(gt), &(pred)));
+
+    nl_block_free( &gt );
+    nl_block_free( &pred );
+}
+
+TEST_CASE("Process Command Length", TEST_TAG){
+    /* nanoparse_process_len must be exact, terminator included */
+    jolt_err_t res;
+    char buf[1024];
+    size_t len;
+
+    nl_block_t gt;
+    state_block_gt( &gt );
+
+    const char *balances[] = { "0", "1", "40200000001000000000000000000000000",
+            "340282366920938463463374607431768211455" };
+    for( uint8_t i = 0; i < sizeof(balances) / sizeof(balances[0]); i++ ) {
+        mbedtls_mpi_read_string(&(gt.balance), 10, balances[i]);
+        len = nanoparse_process_len(&gt);
+        TEST_ASSERT_TRUE(len > 0 && len <= sizeof(buf));
+
+        memset(buf, 'x', sizeof(buf));
+        res = nanoparse_process(&gt, buf, len - 1);
+        TEST_ASSERT_EQUAL(E_INSUFFICIENT_BUF, res);
+        TEST_ASSERT_EQUAL('x', buf[0]);
+
+        res = nanoparse_process(&gt, buf, len);
+        TEST_ASSERT_EQUAL(E_SUCCESS, res);
+        TEST_ASSERT_EQUAL(len - 1, strlen(buf));
+        TEST_ASSERT_EQUAL('x', buf[len]);
+    }
+
+    /* Doesn't fit in 128 bits */
+    mbedtls_mpi_read_string(&(gt.balance), 10, "340282366920938463463374607431768211456");
+    TEST_ASSERT_EQUAL(0, nanoparse_process_len(&gt));
+    res = nanoparse_process(&gt, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+
+    nl_block_free( &gt );
+}
+
+TEST_CASE("Amount Parse and Format", TEST_TAG){
+    jolt_err_t res;
+    nanoparse_amount_t amount;
+    char buf[NANOPARSE_AMOUNT_DEC_BUF_LEN];
+    const char *max = "340282366920938463463374607431768211455";
+    const char *overflow = "340282366920938463463374607431768211456";
+
+    res = nanoparse_amount_from_dec(&amount, max, strlen(max));
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, amount.hi);
+    TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, amount.lo);
+    res = nanoparse_amount_to_dec(buf, sizeof(buf), &amount);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_STRING(max, buf);
+
+    res = nanoparse_amount_from_dec(&amount, overflow, strlen(overflow));
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+    res = nanoparse_amount_from_dec(&amount, "12a4", 4);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+
+    res = nanoparse_amount_from_dec(&amount, "1000000000000000000000", 22);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    res = nanoparse_amount_to_dec(buf, sizeof(buf), &amount);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_STRING("1000000000000000000000", buf);
+    res = nanoparse_amount_to_hex(buf, sizeof(buf), &amount);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_STRING("000000000000003635C9ADC5DEA00000", buf);
+
+    res = nanoparse_amount_from_hex(&amount, "0000000694140DC0A578AED10D000000", 32);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    res = nanoparse_amount_to_dec(buf, sizeof(buf), &amount);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_STRING("521197000000000000000000000000", buf);
+
+    res = nanoparse_amount_to_dec(buf, 4, &amount);
+    TEST_ASSERT_EQUAL(E_INSUFFICIENT_BUF, res);
+}
+
+TEST_CASE("Pending Hash and Amount (no bignum)", TEST_TAG){
+    jolt_err_t res;
+    hex256_t pending_hash;
+    nanoparse_amount_t amount;
+    const char *json_data = "{\n    \"blocks\": {\n        \"xrb_1111111111111111111111111111111111111111111111111111hifc8npp\": {\n            \"00003F1C2F438F98F77771BBD140A58E976BF7A3B2D8EA8D9016DA7AED92EB14\": {\n                \"amount\": \"1000000000000000000000000000000\",\n                \"source\": \"xrb_1hnt56nto4id54wt66rpttwd4xgmzucohdpeacc3yzrnzr9g1tm9tkk9s8jc\"\n            }\n        }\n    }\n}\n";
+    res = nanoparse_pending_hash_amount( json_data, pending_hash, &amount);
+
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_STRING(
+            "00003F1C2F438F98F77771BBD140A58E976BF7A3B2D8EA8D9016DA7AED92EB14",
+            pending_hash);
+    TEST_ASSERT_EQUAL_UINT64(0x0000000C9F2C9CD0ULL, amount.hi);
+    TEST_ASSERT_EQUAL_UINT64(0x4674EDEA40000000ULL, amount.lo);
+}
+
+TEST_CASE("Account Frontiers (batch)", TEST_TAG){
+    const char *json_data = "{\n    \"frontiers\": {\n        \"xrb_3tw77cfpwfnkqrjb988sh91tzerwu5dfnzxy8b3u76r7a7xwnkawm37ctcsb\": \"33832030C4F99FD37C8CD8399911D47150FCB90AE3A791970DBC8D05DFF93B8B\",\n        \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\": \"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\"\n    }\n}\n";
+    nanoparse_frontier_t frontiers[2];
+    uint256_t account, frontier;
+    size_t n;
+    jolt_err_t err;
+
+    err = nanoparse_account_frontiers(json_data, frontiers, 2, &n);
+    TEST_ASSERT_EQUAL(E_SUCCESS, err);
+    TEST_ASSERT_EQUAL(2, n);
+
+    nl_address_to_public(account, "xrb_3tw77cfpwfnkqrjb988sh91tzerwu5dfnzxy8b3u76r7a7xwnkawm37ctcsb");
+    sodium_hex2bin(frontier, sizeof(frontier),
+            "33832030C4F99FD37C8CD8399911D47150FCB90AE3A791970DBC8D05DFF93B8B",
+            HEX_256, NULL, NULL, NULL);
+    TEST_ASSERT_EQUAL_MEMORY(account, frontiers[0].account, sizeof(account));
+    TEST_ASSERT_EQUAL_MEMORY(frontier, frontiers[0].frontier, sizeof(frontier));
+
+    nl_address_to_public(account, "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb");
+    sodium_hex2bin(frontier, sizeof(frontier),
+            "6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655",
+            HEX_256, NULL, NULL, NULL);
+    TEST_ASSERT_EQUAL_MEMORY(account, frontiers[1].account, sizeof(account));
+    TEST_ASSERT_EQUAL_MEMORY(frontier, frontiers[1].frontier, sizeof(frontier));
+
+    /* Too small of an output array */
+    err = nanoparse_account_frontiers(json_data, frontiers, 1, &n);
+    TEST_ASSERT_EQUAL(E_INSUFFICIENT_BUF, err);
+    TEST_ASSERT_EQUAL(1, n);
+
+    /* No frontiers at all */
+    err = nanoparse_account_frontiers("{\"frontiers\": \"\"}", frontiers, 2, &n);
+    TEST_ASSERT_EQUAL(E_SUCCESS, err);
+    TEST_ASSERT_EQUAL(0, n);
+
+    err = nanoparse_account_frontiers("{ \"hello\": \"world\" }", frontiers, 2, &n);
+    TEST_ASSERT_EQUAL(E_FAILURE, err);
+}
+
+typedef struct pending_test_t {
+    int n;
+    int n_amount;
+    int n_source;
+    uint256_t last_account;
+    uint256_t last_hash;
+    nanoparse_amount_t last_amount;
+} pending_test_t;
+
+static jolt_err_t pending_test_cb(const uint256_t account,
+        const uint256_t block_hash, const nanoparse_amount_t *amount,
+        const uint256_t source, void *ctx){
+    pending_test_t *t = ctx;
+    t->n++;
+    memcpy(t->last_account, account, sizeof(t->last_account));
+    memcpy(t->last_hash, block_hash, sizeof(t->last_hash));
+    if( NULL != amount ) {
+        t->n_amount++;
+        t->last_amount = *amount;
+    }
+    if( NULL != source ) {
+        t->n_source++;
+    }
+    return t->n < 100 ? E_SUCCESS : E_INSUFFICIENT_BUF;
+}
+
+TEST_CASE("Accounts Pending (streaming)", TEST_TAG){
+    const char *json_source = "{\n    \"blocks\": {\n        \"xrb_1111111111111111111111111111111111111111111111111117353trpda\": {\n            \"142A538F36833D1CC78B94E11C766F75818F8B940771335C6C1B8AB880C5BB1D\": {\n                \"amount\": \"6000000000000000000000000000000\",\n                \"source\": \"xrb_3dcfozsmekr1tr9skf1oa5wbgmxt81qepfdnt7zicq5x3hk65fg4fqj58mbr\"\n            },\n            \"4C1FEEF0BEA7F50BE35489A1233FE002B212DEA554B55B1B470D78BD8F210C74\": {\n                \"amount\": \"1\",\n                \"source\": \"xrb_3dcfozsmekr1tr9skf1oa5wbgmxt81qepfdnt7zicq5x3hk65fg4fqj58mbr\"\n            }\n        },\n        \"xrb_3t6k35gi95xu6tergt6p69ck76ogmitsa8mnijtpxm9fkcm736xtoncuohr3\": \"\",\n        \"xrb_3dcfozsmekr1tr9skf1oa5wbgmxt81qepfdnt7zicq5x3hk65fg4fqj58mbr\": {\n            \"A7B2C8E4F62A4C6D2C58A6AD0BE57CDF1B1D9B6D1F1A2E0E4ABEFE3E6E6A8B42\": {\n                \"amount\": \"42\",\n                \"source\": \"xrb_1111111111111111111111111111111111111111111111111117353trpda\"\n            }\n        }\n    }\n}\n";
+    const char *json_hashes = "{\"blocks\": {\"xrb_1111111111111111111111111111111111111111111111111117353trpda\": [\"142A538F36833D1CC78B94E11C766F75818F8B940771335C6C1B8AB880C5BB1D\", \"4C1FEEF0BEA7F50BE35489A1233FE002B212DEA554B55B1B470D78BD8F210C74\"]}}";
+    const char *json_threshold = "{\"blocks\": {\"xrb_1111111111111111111111111111111111111111111111111117353trpda\": {\"142A538F36833D1CC78B94E11C766F75818F8B940771335C6C1B8AB880C5BB1D\": \"6000000000000000000000000000000\"}}}";
+    pending_test_t t;
+    uint256_t account, block_hash;
+    nanoparse_amount_t amount;
+    jolt_err_t err;
+
+    memset(&t, 0, sizeof(t));
+    err = nanoparse_accounts_pending(json_source, pending_test_cb, &t);
+    TEST_ASSERT_EQUAL(E_SUCCESS, err);
+    TEST_ASSERT_EQUAL(3, t.n);
+    TEST_ASSERT_EQUAL(3, t.n_amount);
+    TEST_ASSERT_EQUAL(3, t.n_source);
+    nl_address_to_public(account, "xrb_3dcfozsmekr1tr9skf1oa5wbgmxt81qepfdnt7zicq5x3hk65fg4fqj58mbr");
+    sodium_hex2bin(block_hash, sizeof(block_hash),
+            "A7B2C8E4F62A4C6D2C58A6AD0BE57CDF1B1D9B6D1F1A2E0E4ABEFE3E6E6A8B42",
+            HEX_256, NULL, NULL, NULL);
+    TEST_ASSERT_EQUAL_MEMORY(account, t.last_account, sizeof(account));
+    TEST_ASSERT_EQUAL_MEMORY(block_hash, t.last_hash, sizeof(block_hash));
+    TEST_ASSERT_TRUE(0 == t.last_amount.hi && 42 == t.last_amount.lo);
+
+    memset(&t, 0, sizeof(t));
+    err = nanoparse_accounts_pending(json_hashes, pending_test_cb, &t);
+    TEST_ASSERT_EQUAL(E_SUCCESS, err);
+    TEST_ASSERT_EQUAL(2, t.n);
+    TEST_ASSERT_EQUAL(0, t.n_amount);
+    TEST_ASSERT_EQUAL(0, t.n_source);
+
+    memset(&t, 0, sizeof(t));
+    err = nanoparse_accounts_pending(json_threshold, pending_test_cb, &t);
+    TEST_ASSERT_EQUAL(E_SUCCESS, err);
+    TEST_ASSERT_EQUAL(1, t.n);
+    TEST_ASSERT_EQUAL(0, t.n_source);
+    nanoparse_amount_from_dec(&amount, "6000000000000000000000000000000", 31);
+    TEST_ASSERT_EQUAL(0, nanoparse_amount_cmp(&amount, &t.last_amount));
+
+    /* Callback errors stop the parse */
+    memset(&t, 0, sizeof(t));
+    t.n = 99;
+    err = nanoparse_accounts_pending(json_source, pending_test_cb, &t);
+    TEST_ASSERT_EQUAL(E_INSUFFICIENT_BUF, err);
+    TEST_ASSERT_EQUAL(100, t.n);
+
+    memset(&t, 0, sizeof(t));
+    err = nanoparse_accounts_pending("{\"blocks\": \"\"}", pending_test_cb, &t);
+    TEST_ASSERT_EQUAL(E_SUCCESS, err);
+    TEST_ASSERT_EQUAL(0, t.n);
+
+    err = nanoparse_accounts_pending("{ \"hello\": \"world\" }", pending_test_cb, &t);
+    TEST_ASSERT_EQUAL(E_FAILURE, err);
+}
+
+TEST_CASE("Accounts Pending (chunked stream)", TEST_TAG){
+    const char *json_data = "{\n    \"blocks\": {\n        \"xrb_1111111111111111111111111111111111111111111111111117353trpda\": {\n            \"142A538F36833D1CC78B94E11C766F75818F8B940771335C6C1B8AB880C5BB1D\": {\n                \"amount\": \"6000000000000000000000000000000\",\n                \"source\": \"xrb_3dcfozsmekr1tr9skf1oa5wbgmxt81qepfdnt7zicq5x3hk65fg4fqj58mbr\"\n            },\n            \"4C1FEEF0BEA7F50BE35489A1233FE002B212DEA554B55B1B470D78BD8F210C74\": {\n                \"amount\": \"1\",\n                \"source\": \"xrb_3dcfozsmekr1tr9skf1oa5wbgmxt81qepfdnt7zicq5x3hk65fg4fqj58mbr\"\n            }\n        },\n        \"xrb_3t6k35gi95xu6tergt6p69ck76ogmitsa8mnijtpxm9fkcm736xtoncuohr3\": \"\",\n        \"xrb_3dcfozsmekr1tr9skf1oa5wbgmxt81qepfdnt7zicq5x3hk65fg4fqj58mbr\": [\"A7B2C8E4F62A4C6D2C58A6AD0BE57CDF1B1D9B6D1F1A2E0E4ABEFE3E6E6A8B42\"]\n    }\n}\n";
+    size_t json_len = strlen(json_data);
+    nanoparse_stream_t s;
+    pending_test_t t;
+    uint256_t account;
+    jolt_err_t err;
+
+    nl_address_to_public(account, "xrb_3dcfozsmekr1tr9skf1oa5wbgmxt81qepfdnt7zicq5x3hk65fg4fqj58mbr");
+    /* Every chunk size must give the same result as the whole response */
+    for( size_t chunk = 1; chunk <= json_len; chunk++ ) {
+        memset(&t, 0, sizeof(t));
+        nanoparse_accounts_pending_stream_init(&s, pending_test_cb, &t);
+        for( size_t i = 0; i < json_len; i += chunk ) {
+            size_t n = json_len - i < chunk ? json_len - i : chunk;
+            err = nanoparse_stream_feed(&s, &json_data[i], n);
+            TEST_ASSERT_EQUAL(E_SUCCESS, err);
+        }
+        err = nanoparse_stream_finish(&s);
+        TEST_ASSERT_EQUAL(E_SUCCESS, err);
+        TEST_ASSERT_EQUAL(3, t.n);
+        TEST_ASSERT_EQUAL(2, t.n_amount);
+        TEST_ASSERT_EQUAL(2, t.n_source);
+        TEST_ASSERT_EQUAL_MEMORY(account, t.last_account, sizeof(account));
+    }
+
+    /* Blocks are delivered before the response is complete */
+    memset(&t, 0, sizeof(t));
+    nanoparse_accounts_pending_stream_init(&s, pending_test_cb, &t);
+    err = nanoparse_stream_feed(&s, json_data, strstr(json_data, "\"4C1FEEF0") - json_data);
+    TEST_ASSERT_EQUAL(E_SUCCESS, err);
+    TEST_ASSERT_EQUAL(1, t.n);
+    TEST_ASSERT_EQUAL(E_FAILURE, nanoparse_stream_finish(&s));
+
+    memset(&t, 0, sizeof(t));
+    nanoparse_accounts_pending_stream_init(&s, pending_test_cb, &t);
+    nanoparse_stream_feed(&s, "{\"blocks\": \"\"}", 14);
+    TEST_ASSERT_EQUAL(E_SUCCESS, nanoparse_stream_finish(&s));
+    TEST_ASSERT_EQUAL(0, t.n);
+
+    nanoparse_accounts_pending_stream_init(&s, pending_test_cb, &t);
+    nanoparse_stream_feed(&s, "{\"error\": \"Bad account number\"}", 32);
+    TEST_ASSERT_EQUAL(E_FAILURE, nanoparse_stream_finish(&s));
+}
+
+TEST_CASE("Accounts Pending (chunked stream, hash arrays)", TEST_TAG){
+    /* "source": "false" replies list hashes in an array; each hash is its
+     * own record, so the array may be far larger than the stream buffer */
+    const size_t n_hashes = 3 * CONFIG_NANOPARSE_STREAM_BUF_LEN / (HEX_256 + 2);
+    const char *account = "xrb_1111111111111111111111111111111111111111111111111117353trpda";
+    size_t json_len = 0, cap = 256 + n_hashes * (HEX_256 + 8);
+    char *json_data = malloc(cap);
+    nanoparse_stream_t s;
+    pending_test_t t;
+    uint256_t expected;
+    jolt_err_t err;
+
+    TEST_ASSERT_NOT_NULL(json_data);
+    json_len += snprintf(json_data, cap, "{\"blocks\": {\"%s\": [", account);
+    for( size_t i = 0; i < n_hashes; i++ ) {
+        json_len += snprintf(&json_data[json_len], cap - json_len,
+                "%s\n  \"%064X\"", i ? "," : "", (unsigned int)i + 1);
+    }
+    json_len += snprintf(&json_data[json_len], cap - json_len,
+            "], \"%s\": \"\"}}", account);
+    TEST_ASSERT_TRUE(json_len > sizeof(s.buf));
+    memset(expected, 0, sizeof(expected));
+    expected[BIN_256 - 2] = n_hashes >> 8;
+    expected[BIN_256 - 1] = n_hashes & 0xFF;
+
+    for( size_t chunk = 1; chunk <= 64; chunk *= 4 ) {
+        memset(&t, 0, sizeof(t));
+        nanoparse_accounts_pending_stream_init(&s, pending_test_cb, &t);
+        for( size_t i = 0; i < json_len; i += chunk ) {
+            size_t n = json_len - i < chunk ? json_len - i : chunk;
+            err = nanoparse_stream_feed(&s, &json_data[i], n);
+            TEST_ASSERT_EQUAL(E_SUCCESS, err);
+        }
+        err = nanoparse_stream_finish(&s);
+        TEST_ASSERT_EQUAL(E_SUCCESS, err);
+        TEST_ASSERT_EQUAL(n_hashes, t.n);
+        TEST_ASSERT_EQUAL(0, t.n_amount);
+        TEST_ASSERT_EQUAL_MEMORY(expected, t.last_hash, BIN_256);
+    }
+    free(json_data);
+}
+
+TEST_CASE("Blocks Info (batch)", TEST_TAG){
+    /* One json_block entry and one legacy string entry, requested in the
+     * opposite order to how the node returns them */
+    jolt_err_t res;
+    const char *json_data = "{\n    \"blocks\": {\n        \"87434F8041869A01C8F6F263B87972D7BA443A72E0A97D7A3FD0CCC2358FD6F9\": {\n            \"block_account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\",\n            \"amount\": \"1000000000000000000000000000000\",\n            \"balance\": \"5606157000000000000000000000000000000\",\n            \"contents\": {\n                \"type\": \"state\",\n                \"account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\",\n                \"previous\": \"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\",\n                \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\",\n                \"balance\": \"0\",\n                \"link\": \"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\",\n                \"signature\": \"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\",\n                \"work\": \"6aa2c8a6e053c0d4\"\n            }\n        },\n        \"4270F4FB3A820FE81827065F967A9589DF5CA860443F812D21ECE964AC359E05\": {\n            \"block_account\": \"xrb_1cwswatjifmjnmtu5toepkwca64m7qtuukizyjxsghujtpdr9466wjmn89d8\",\n            \"amount\": \"0\",\n            \"contents\": \"{\\n    \\\"type\\\": \\\"change\\\",\\n    \\\"previous\\\": \\\"AF9C1D46AAE66CC8F827904ED02D4B3D95AA98B1FF058352BA6B670BEFD40231\\\",\\n    \\\"representative\\\": \\\"xrb_1cwswatjifmjnmtu5toepkwca64m7qtuukizyjxsghujtpdr9466wjmn89d8\\\",\\n    \\\"work\\\": \\\"e8c2c556c9cfb6e2\\\",\\n    \\\"signature\\\": \\\"A039A7BF5E54B44F45A8E1AD9940A81C87CC66C04AFA738367956629A5EF49E49D297FA3CDD195BDA8373D144F9E1D4641737E7F372CEAB5AD2F3B8E9852A30D\\\"\\n}\\n\"\n        }\n    }\n}\n";
+    uint256_t hashes[2];
+    nl_block_t gt[2];
+    nl_block_t pred[2];
+
+    sodium_hex2bin(hashes[0], sizeof(hashes[0]),
+            "4270F4FB3A820FE81827065F967A9589DF5CA860443F812D21ECE964AC359E05",
+            HEX_256, NULL, NULL, NULL);
+    sodium_hex2bin(hashes[1], sizeof(hashes[1]),
+            "87434F8041869A01C8F6F263B87972D7BA443A72E0A97D7A3FD0CCC2358FD6F9",
+            HEX_256, NULL, NULL, NULL);
+
+    // Setup Test Vectors
+    nl_block_init( &gt[0] );
+    gt[0].type = CHANGE;
+    sodium_hex2bin(gt[0].previous, sizeof(gt[0].previous),
+            "AF9C1D46AAE66CC8F827904ED02D4B3D95AA98B1FF058352BA6B670BEFD40231",
+            HEX_256, NULL, NULL, NULL);
+    // From "block_account"; legacy change blocks don't carry it
+    nl_address_to_public(gt[0].account, "xrb_1cwswatjifmjnmtu5toepkwca64m7qtuukizyjxsghujtpdr9466wjmn89d8");
+    nl_address_to_public(gt[0].representative, "xrb_1cwswatjifmjnmtu5toepkwca64m7qtuukizyjxsghujtpdr9466wjmn89d8");
+    nl_parse_server_work_string("e8c2c556c9cfb6e2", &(gt[0].work));
+    sodium_hex2bin(gt[0].signature, sizeof(gt[0].signature),
+            "A039A7BF5E54B44F45A8E1AD9940A81C87CC66C04AFA738367956629A5EF49E4"
+            "9D297FA3CDD195BDA8373D144F9E1D4641737E7F372CEAB5AD2F3B8E9852A30D",
+            HEX_512, NULL, NULL, NULL);
+    state_block_gt( &gt[1] );
+
+    // Test Parser
+    nl_block_init( &pred[0] );
+    nl_block_init( &pred[1] );
+    res = nanoparse_blocks_info(json_data, hashes, 2, pred);
+
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(nl_block_equal(&(gt[0]), &(pred[0])));
+    TEST_ASSERT_TRUE(nl_block_equal(&(gt[1]), &(pred[1])));
+    TEST_ASSERT_EQUAL(E_SUCCESS, nanoparse_block_verify(&pred[0]));
+    TEST_ASSERT_EQUAL(E_SUCCESS, nanoparse_blocks_verify(pred, 2, 1, NULL));
+
+    /* A requested block that wasn't returned */
+    hashes[1][0] ^= 0xFF;
+    res = nanoparse_blocks_info(json_data, hashes, 2, pred);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+
+    res = nanoparse_blocks_info("{ \"hello\": \"world\" }", hashes, 2, pred);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+
+    ESP_ERROR_CHECK( !heap_caps_check_integrity_all(0) );
+
+    nl_block_free( &gt[0] );
+    nl_block_free( &gt[1] );
+    nl_block_free( &pred[0] );
+    nl_block_free( &pred[1] );
+}
+
+TEST_CASE("Account Info", TEST_TAG){
+    const char *json_data = "{\n    \"frontier\": \"FF84533A571D953A596EA401FD41743AC85D04F406E76FDE4408EAED50B473C5\",\n    \"open_block\": \"991CF190094C00F0B68E2E5F75F6BEE95A2E0BD93CEAA4A6734DB9F19B728948\",\n    \"representative_block\": \"991CF190094C00F0B68E2E5F75F6BEE95A2E0BD93CEAA4A6734DB9F19B728948\",\n    \"balance\": \"235580100176034320859259343606608761791\",\n    \"modified_timestamp\": \"1501793775\",\n    \"block_count\": \"33\",\n    \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\"\n}\n";
+    nanoparse_account_info_t info;
+    nanoparse_amount_t balance;
+    uint256_t frontier, representative;
+    jolt_err_t res;
+
+    res = nanoparse_account_info(json_data, &info);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+
+    sodium_hex2bin(frontier, sizeof(frontier),
+            "FF84533A571D953A596EA401FD41743AC85D04F406E76FDE4408EAED50B473C5",
+            HEX_256, NULL, NULL, NULL);
+    TEST_ASSERT_EQUAL_MEMORY(frontier, info.frontier, sizeof(frontier));
+    nl_address_to_public(representative, "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb");
+    TEST_ASSERT_EQUAL_MEMORY(representative, info.representative, sizeof(representative));
+    nanoparse_amount_from_dec(&balance, "235580100176034320859259343606608761791", 39);
+    TEST_ASSERT_EQUAL(0, nanoparse_amount_cmp(&balance, &info.balance));
+    TEST_ASSERT_EQUAL(33, info.block_count);
+    TEST_ASSERT_EQUAL(1501793775, info.modified_timestamp);
+
+    res = nanoparse_account_info("{\"error\": \"Account not found\"}", &info);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+}
+
+TEST_CASE("Next Block (account_info)", TEST_TAG){
+    const char *json_data = "{\n    \"frontier\": \"FF84533A571D953A596EA401FD41743AC85D04F406E76FDE4408EAED50B473C5\",\n    \"open_block\": \"991CF190094C00F0B68E2E5F75F6BEE95A2E0BD93CEAA4A6734DB9F19B728948\",\n    \"representative_block\": \"991CF190094C00F0B68E2E5F75F6BEE95A2E0BD93CEAA4A6734DB9F19B728948\",\n    \"balance\": \"235580100176034320859259343606608761791\",\n    \"modified_timestamp\": \"1501793775\",\n    \"block_count\": \"33\",\n    \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\"\n}\n";
+    const char *no_rep = "{\"frontier\": \"FF84533A571D953A596EA401FD41743AC85D04F406E76FDE4408EAED50B473C5\", \"open_block\": \"991CF190094C00F0B68E2E5F75F6BEE95A2E0BD93CEAA4A6734DB9F19B728948\", \"representative_block\": \"991CF190094C00F0B68E2E5F75F6BEE95A2E0BD93CEAA4A6734DB9F19B728948\", \"balance\": \"1\", \"block_count\": \"33\"}";
+    jolt_err_t res;
+
+    nl_block_t gt;
+    nl_block_init( &gt );
+    gt.type = STATE;
+    nl_address_to_public(gt.account, "xrb_3tw77cfpwfnkqrjb988sh91tzerwu5dfnzxy8b3u76r7a7xwnkawm37ctcsb");
+    sodium_hex2bin(gt.previous, sizeof(gt.previous),
+            "FF84533A571D953A596EA401FD41743AC85D04F406E76FDE4408EAED50B473C5",
+            HEX_256, NULL, NULL, NULL);
+    nl_address_to_public(gt.representative, "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb");
+    mbedtls_mpi_read_string(&(gt.balance), 10, "235580100176034320859259343606608761791");
+
+    nl_block_t pred;
+    nl_block_init( &pred );
+    memcpy(pred.account, gt.account, sizeof(pred.account));
+    memset(pred.link, 0xFF, sizeof(pred.link));
+    res = nanoparse_next_block(json_data, &pred);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(nl_block_equal(&(gt), &(pred)));
+
+    res = nanoparse_next_block(no_rep, &pred);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+    res = nanoparse_next_block("{\"error\": \"Account not found\"}", &pred);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+
+    nl_block_free( &gt );
+    nl_block_free( &pred );
+}
+
+TEST_CASE("Account Balance", TEST_TAG){
+    const char *json_data = "{\n    \"balance\": \"10000\",\n    \"pending\": \"340282366920938463463374607431768211455\"\n}\n";
+    nanoparse_account_balance_t balance;
+    jolt_err_t res;
+
+    res = nanoparse_account_balance(json_data, &balance);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(0 == balance.balance.hi && 10000 == balance.balance.lo);
+    TEST_ASSERT_TRUE(UINT64_MAX == balance.pending.hi && UINT64_MAX == balance.pending.lo);
+
+    res = nanoparse_account_balance("{\"balance\": \"10000\"}", &balance);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+    res = nanoparse_account_balance("{\"balance\": \"1x\", \"pending\": \"0\"}", &balance);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+}
+
+TEST_CASE("Parse Block (arena)", TEST_TAG){
+    jolt_err_t res;
+    const char *json_data = "{\n    \"contents\": \"{\\n    \\\"type\\\": \\\"state\\\",\\n    \\\"account\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n    \\\"previous\\\": \\\"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\\\",\\n    \\\"representative\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n    \\\"balance\\\": \\\"0\\\",\\n    \\\"link\\\": \\\"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\\\",\\n    \\\"link_as_account\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n    \\\"signature\\\": \\\"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\\\",\\n    \\\"work\\\": \\\"6aa2c8a6e053c0d4\\\"\\n}\\n\"\n}\n";
+    static uint8_t buf[8192];
+    nanoparse_arena_t arena;
+    nl_block_t block;
+
+    nl_block_init( &block );
+    nanoparse_arena_init(&arena, buf, sizeof(buf));
+    nanoparse_arena_attach(&arena);
+
+    res = nanoparse_block(json_data, &block);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL(STATE, block.type);
+    TEST_ASSERT_EQUAL_UINT(0, arena.used);
+#if CONFIG_NANOPARSE_BLOCK_BACKEND_TOKENIZER
+    TEST_ASSERT_EQUAL_UINT(0, arena.peak);
+#else
+    static uint8_t small_buf[64];
+    nanoparse_arena_t small;
+
+    TEST_ASSERT_TRUE(arena.peak > 0);
+    TEST_ASSERT_TRUE(arena.peak <= sizeof(buf));
+    TEST_ASSERT_EQUAL_UINT(arena.peak, arena.max_peak);
+
+    // Reused from the start on the next call
+    res = nanoparse_block(json_data, &block);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_UINT(arena.max_peak, arena.peak);
+
+    nanoparse_arena_init(&small, small_buf, sizeof(small_buf));
+    nanoparse_arena_attach(&small);
+    res = nanoparse_block(json_data, &block);
+    TEST_ASSERT_EQUAL(E_INSUFFICIENT_BUF, res);
+#endif
+
+    nanoparse_arena_attach(NULL);
+    res = nanoparse_block(json_data, &block);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+
+    ESP_ERROR_CHECK( !heap_caps_check_integrity_all(0) );
+
+    nl_block_free( &block );
+}
+
+TEST_CASE("Block Cache", TEST_TAG){
+    static nanoparse_block_cache_t cache;
+    uint256_t hash;
+    nl_block_t block, out;
+    jolt_err_t res;
+
+    nl_block_init( &block );
+    nl_block_init( &out );
+    block.type = STATE;
+    nl_address_to_public(block.account, "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb");
+    memset(block.signature, 0xA5, sizeof(block.signature));
+    block.work = 0x6aa2c8a6e053c0d4;
+    mbedtls_mpi_read_string(&(block.balance), 10, "340282366920938463463374607431768211455");
+
+    // Garbage isn't adopted
+    memset(&cache, 0xFF, sizeof(cache));
+    TEST_ASSERT_FALSE(nanoparse_block_cache_open(&cache));
+
+    // Fill past capacity; block i has previous[0] == i
+    for( int i = 0; i <= CONFIG_NANOPARSE_BLOCK_CACHE_LEN; i++ ) {
+        if( CONFIG_NANOPARSE_BLOCK_CACHE_LEN == i ) {
+            // Touch block 0 so block 1 is the one evicted
+            int first = 0;
+            crypto_generichash(hash, sizeof(hash), (uint8_t *)&first, sizeof(first), NULL, 0);
+            res = nanoparse_block_cache_get(&cache, hash, &out);
+            TEST_ASSERT_EQUAL(E_SUCCESS, res);
+        }
+        crypto_generichash(hash, sizeof(hash), (uint8_t *)&i, sizeof(i), NULL, 0);
+        block.previous[0] = i;
+        res = nanoparse_block_cache_put(&cache, hash, &block);
+        TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    }
+
+    for( int i = 0; i <= CONFIG_NANOPARSE_BLOCK_CACHE_LEN; i++ ) {
+        crypto_generichash(hash, sizeof(hash), (uint8_t *)&i, sizeof(i), NULL, 0);
+        res = nanoparse_block_cache_get(&cache, hash, &out);
+        if( 1 == i ) {
+            TEST_ASSERT_EQUAL(E_FAILURE, res);
+            continue;
+        }
+        TEST_ASSERT_EQUAL(E_SUCCESS, res);
+        block.previous[0] = i;
+        TEST_ASSERT_TRUE(nl_block_equal(&block, &out));
+    }
+    TEST_ASSERT_EQUAL_UINT(CONFIG_NANOPARSE_BLOCK_CACHE_LEN + 1, cache.hits);
+    TEST_ASSERT_EQUAL_UINT(1, cache.misses);
+
+    // A restart with intact memory keeps the contents
+    TEST_ASSERT_TRUE(nanoparse_block_cache_open(&cache));
+    TEST_ASSERT_EQUAL_UINT(CONFIG_NANOPARSE_BLOCK_CACHE_LEN, cache.count);
+
+    // A torn LRU list is detected
+    cache.links[cache.newest].older = cache.newest;
+    TEST_ASSERT_FALSE(nanoparse_block_cache_open(&cache));
+    TEST_ASSERT_EQUAL_UINT(0, cache.count);
+
+    nl_block_free( &block );
+    nl_block_free( &out );
+}
+
+/* Local mock node for the async rpc tests. Requests are answered newest
+ * first, so replies always complete out of order. */
+typedef struct mock_node_t {
+    uint32_t ids[CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT];
+    const char *replies[CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT];
+    size_t n;
+    bool drop;   // Lose every request, like a closed socket
+    int n_cancelled;
+} mock_node_t;
+
+static jolt_err_t mock_node_submit(void *ctx, uint32_t id, const char *cmd){
+    mock_node_t *node = ctx;
+    const char *reply;
+
+    if( strstr(cmd, "\"action\":\"block\"") ) {
+        reply = "{\n    \"contents\": {\n        \"type\": \"state\",\n        \"account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\",\n        \"previous\": \"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\",\n        \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\",\n        \"balance\": \"0\",\n        \"link\": \"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\",\n        \"link_as_account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\",\n        \"signature\": \"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\",\n        \"work\": \"6aa2c8a6e053c0d4\"\n    }\n}\n";
+    }
+    else if( strstr(cmd, "\"action\":\"account_info\"") ) {
+        reply = "{\n    \"frontier\": \"FF84533A571D953A596EA401FD41743AC85D04F406E76FDE4408EAED50B473C5\",\n    \"open_block\": \"991CF190094C00F0B68E2E5F75F6BEE95A2E0BD93CEAA4A6734DB9F19B728948\",\n    \"representative_block\": \"991CF190094C00F0B68E2E5F75F6BEE95A2E0BD93CEAA4A6734DB9F19B728948\",\n    \"balance\": \"235580100176034320859259343606608761791\",\n    \"modified_timestamp\": \"1501793775\",\n    \"block_count\": \"33\",\n    \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\"\n}\n";
+    }
+    else if( strstr(cmd, "\"action\":\"account_balance\"") ) {
+        reply = "{\n    \"balance\": \"10000\",\n    \"pending\": \"10000\"\n}\n";
+    }
+    else {
+        reply = "{\"error\": \"Unknown command\"}";
+    }
+    if( node->drop ) {
+        return E_SUCCESS;
+    }
+    node->ids[node->n] = id;
+    node->replies[node->n] = reply;
+    node->n++;
+    return E_SUCCESS;
+}
+
+static jolt_err_t mock_node_poll(void *ctx, uint32_t *id, const char **reply){
+    mock_node_t *node = ctx;
+    if( 0 == node->n ) {
+        return E_FAILURE;
+    }
+    node->n--;
+    *id = node->ids[node->n];
+    *reply = node->replies[node->n];
+    return E_SUCCESS;
+}
+
+static void mock_node_cancel(void *ctx, uint32_t id){
+    mock_node_t *node = ctx;
+    node->n_cancelled++;
+}
+
+static void rpc_test_cb(jolt_err_t res, void *out, void *ctx){
+    int *n_ok = ctx;
+    if( E_SUCCESS == res ) {
+        (*n_ok)++;
+    }
+}
+
+TEST_CASE("Async RPC (mock node)", TEST_TAG){
+    mock_node_t node = { 0 };
+    const nanoparse_transport_t transport = {
+        .submit = mock_node_submit,
+        .poll = mock_node_poll,
+        .cancel = mock_node_cancel,
+        .ctx = &node,
+    };
+    nanoparse_rpc_t rpc, other;
+    nl_block_t block, next;
+    nanoparse_account_info_t info;
+    nanoparse_account_balance_t balances[CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT];
+    int n_ok = 0;
+    jolt_err_t res;
+
+    nl_block_init( &block );
+    nl_block_init( &next );
+    nanoparse_rpc_init(&rpc, &transport);
+
+    res = nanoparse_rpc_block(&rpc,
+            "EA9D15EE857E3C140884A2D3DABD1B5C51AFBB3466D0F61E733B747FDDF858B9",
+            &block, rpc_test_cb, &n_ok);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    res = nanoparse_rpc_account_info(&rpc,
+            "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb",
+            &info, rpc_test_cb, &n_ok);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    nl_address_to_public(next.account, "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb");
+    res = nanoparse_rpc_next_block(&rpc, &next, rpc_test_cb, &n_ok);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL(3, rpc.in_flight);
+    TEST_ASSERT_EQUAL(0, n_ok);
+
+    TEST_ASSERT_EQUAL(3, nanoparse_rpc_poll(&rpc));
+    TEST_ASSERT_EQUAL(3, n_ok);
+    TEST_ASSERT_EQUAL(STATE, block.type);
+    TEST_ASSERT_EQUAL(33, info.block_count);
+    TEST_ASSERT_EQUAL_MEMORY(info.frontier, next.previous, sizeof(next.previous));
+
+    // The node answers with a block other than the one requested
+    n_ok = 0;
+    res = nanoparse_rpc_block(&rpc,
+            "6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655",
+            &block, rpc_test_cb, &n_ok);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL(1, nanoparse_rpc_poll(&rpc));
+    TEST_ASSERT_EQUAL(0, n_ok);
+
+    // Every slot in flight at once
+    n_ok = 0;
+    for( int i = 0; i < CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT; i++ ) {
+        res = nanoparse_rpc_account_balance(&rpc,
+                "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb",
+                &balances[i], rpc_test_cb, &n_ok);
+        TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    }
+    res = nanoparse_rpc_account_balance(&rpc,
+            "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb",
+            &balances[0], rpc_test_cb, &n_ok);
+    TEST_ASSERT_EQUAL(E_INSUFFICIENT_BUF, res);
+    res = nanoparse_rpc_wait(&rpc, 1000);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL(CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT, n_ok);
+    TEST_ASSERT_EQUAL(0, rpc.in_flight);
+    for( int i = 0; i < CONFIG_NANOPARSE_RPC_MAX_IN_FLIGHT; i++ ) {
+        TEST_ASSERT_TRUE(10000 == balances[i].balance.lo && 10000 == balances[i].pending.lo);
+    }
+
+    // Lost replies time out and free their slots
+    n_ok = 0;
+    node.drop = true;
+    res = nanoparse_rpc_account_info(&rpc,
+            "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb",
+            &info, rpc_test_cb, &n_ok);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    res = nanoparse_rpc_wait(&rpc, 10);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+    TEST_ASSERT_EQUAL(0, n_ok);
+    TEST_ASSERT_EQUAL(0, rpc.in_flight);
+    res = nanoparse_rpc_account_info(&rpc,
+            "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb",
+            &info, rpc_test_cb, &n_ok);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL(1, nanoparse_rpc_cancel(&rpc));
+    TEST_ASSERT_EQUAL(0, rpc.in_flight);
+    TEST_ASSERT_EQUAL(2, node.n_cancelled);
+
+    // Contexts sharing a transport never reuse each other's ids
+    nanoparse_rpc_init(&other, &transport);
+    res = nanoparse_rpc_account_info(&rpc,
+            "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb",
+            &info, rpc_test_cb, &n_ok);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    res = nanoparse_rpc_account_info(&other,
+            "xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb",
+            &info, rpc_test_cb, &n_ok);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(rpc.slots[0].id != other.slots[0].id);
+    nanoparse_rpc_cancel(&rpc);
+    nanoparse_rpc_cancel(&other);
+
+    nl_block_free( &block );
+    nl_block_free( &next );
+}
+
+TEST_CASE("Receive Buffer Pool", TEST_TAG){
+    nanoparse_buf_t a, b;
+    nanoparse_pool_stats_t before, after;
+    char *first;
+    jolt_err_t res;
+
+    nanoparse_pool_trim();
+    nanoparse_pool_stats(&before);
+
+    res = nanoparse_pool_get(&a, 100);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_UINT(NANOPARSE_POOL_MIN_LEN, a.len);
+    first = a.data;
+    nanoparse_pool_put(&a);
+    TEST_ASSERT_NULL(a.data);
+
+    // Reused rather than reallocated
+    res = nanoparse_pool_get(&a, NANOPARSE_POOL_MIN_LEN);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(first == a.data);
+
+    res = nanoparse_pool_get(&b, NANOPARSE_POOL_MIN_LEN + 1);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_UINT(2 * NANOPARSE_POOL_MIN_LEN, b.len);
+
+    res = nanoparse_pool_grow(&a);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_UINT(2 * NANOPARSE_POOL_MIN_LEN, a.len);
+    memset(a.data, 'x', a.len);
+
+    nanoparse_pool_stats(&after);
+    TEST_ASSERT_EQUAL_UINT(before.in_use + 4 * NANOPARSE_POOL_MIN_LEN, after.in_use);
+    TEST_ASSERT_TRUE(after.high_water >= after.in_use);
+    TEST_ASSERT_EQUAL_UINT(before.hits + 1, after.hits);
+    TEST_ASSERT_EQUAL_UINT(before.grows + 1, after.grows);
+
+    nanoparse_pool_put(&a);
+    nanoparse_pool_put(&b);
+    nanoparse_pool_stats(&after);
+    TEST_ASSERT_EQUAL_UINT(before.in_use, after.in_use);
+
+    res = nanoparse_pool_get(&a, CONFIG_NANOPARSE_POOL_MAX_LEN + 1);
+    TEST_ASSERT_EQUAL(E_INSUFFICIENT_BUF, res);
+    res = nanoparse_pool_get(&a, CONFIG_NANOPARSE_POOL_MAX_LEN);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    res = nanoparse_pool_grow(&a);
+    TEST_ASSERT_EQUAL(E_INSUFFICIENT_BUF, res);
+    nanoparse_pool_put(&a);
+
+    nanoparse_pool_trim();
+    nanoparse_pool_stats(&after);
+    TEST_ASSERT_EQUAL_UINT(0, after.cached);
+}
+
+TEST_CASE("Local Work Generation", TEST_TAG){
+    uint256_t root, digest;
+    uint8_t msg[8 + BIN_256];
+    uint64_t work, value, expected, hashes;
+    nanoparse_work_opts_t opts = { 0 };
+    volatile bool cancel = true;
+    jolt_err_t res;
+
+    sodium_hex2bin(root, sizeof(root),
+            "718CC2121C3E641059BC1C2CFC45666C99E8AE922F7A807B7D07B62C995D79E2",
+            64, NULL, NULL, NULL);
+    value = nanoparse_work_value(root, 0x2bf29ef00786a6bc);
+    TEST_ASSERT_TRUE(0xffffffd21c3933f4 == value);
+    TEST_ASSERT_TRUE(value >= NANOPARSE_WORK_THRESHOLD);
+
+    sodium_hex2bin(root, sizeof(root),
+            "6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655",
+            64, NULL, NULL, NULL);
+    TEST_ASSERT_TRUE(0xfffffff7c0824179 == nanoparse_work_value(root, 0x6aa2c8a6e053c0d4));
+
+    // Agrees with libsodium for arbitrary nonces
+    for( uint8_t i = 0; i < 16; i++ ) {
+        randombytes_buf(&work, sizeof(work));
+        for( uint8_t j = 0; j < 8; j++ ) {
+            msg[j] = (work >> (8 * j)) & 0xFF;
+        }
+        memcpy(&msg[8], root, BIN_256);
+        crypto_generichash(digest, 8, msg, sizeof(msg), NULL, 0);
+        expected = 0;
+        for( int8_t j = 7; j >= 0; j-- ) {
+            expected = (expected << 8) | digest[j];
+        }
+        TEST_ASSERT_TRUE(expected == nanoparse_work_value(root, work));
+    }
+
+    // An easy threshold so the test finishes quickly on any target
+    opts.threshold = 0xff00000000000000;
+    res = nanoparse_work_generate(root, &opts, &work, &hashes);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(nanoparse_work_value(root, work) >= opts.threshold);
+    TEST_ASSERT_TRUE(hashes > 0);
+
+    opts.threshold = 0;
+    opts.cancel = &cancel;
+    res = nanoparse_work_generate(root, &opts, &work, NULL);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+}
+
+TEST_CASE("Work Validation", TEST_TAG){
+    uint256_t roots[6];
+    uint64_t works[6];
+    bool valid[6];
+    nl_block_t blocks[2];
+    jolt_err_t res;
+    const char *json_open = "{\"contents\": {\"type\": \"open\", \"source\": \"32E0D2FE367522FBFA29EB93940EC3AE5E1315DD9C6A73B3DE2A8BC683B64367\", \"representative\": \"xrb_3hd4ezdgsp15iemx7h81in7xz5tpxi43b6b41zn3qmwiuypankocw3awes5k\", \"account\": \"xrb_3dmtrrws3pocycmbqwawk6xs7446qxa36fcncush4s1pejk16ksbmakis78m\", \"work\": \"21bcc2816e10165d\", \"signature\": \"2CA07C59BF80B04515D49480EF0B5918BA29F998AB84120BB4B33A1A49BC028F0DB86CED729BF17B2CFF64F92011DC7F0089CDBF283C392F242A9F42DFA66000\"}}";
+    const char *json_state = "{\"contents\": {\"type\": \"state\", \"account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\", \"previous\": \"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\", \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\", \"balance\": \"0\", \"link\": \"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\", \"signature\": \"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\", \"work\": \"6aa2c8a6e053c0d4\"}}";
+
+    // More pairs than lanes, with a bad one in the tail
+    for( uint8_t i = 0; i < 6; i++ ) {
+        sodium_hex2bin(roots[i], sizeof(roots[i]),
+                "718CC2121C3E641059BC1C2CFC45666C99E8AE922F7A807B7D07B62C995D79E2",
+                64, NULL, NULL, NULL);
+        works[i] = 0x2bf29ef00786a6bc;
+    }
+    res = nanoparse_work_validate(roots, works, 6, 0, valid);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    works[5] ^= 1;
+    res = nanoparse_work_validate(roots, works, 6, 0, valid);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+    for( uint8_t i = 0; i < 5; i++ ) {
+        TEST_ASSERT_TRUE(valid[i]);
+    }
+    TEST_ASSERT_FALSE(valid[5]);
+
+    // The first block of an account is rooted at the account itself
+    nl_block_init(&blocks[0]);
+    nl_block_init(&blocks[1]);
+    res = nanoparse_block(json_open, &blocks[0]);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    res = nanoparse_block(json_state, &blocks[1]);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    nanoparse_block_root(&blocks[0], roots[0]);
+    TEST_ASSERT_EQUAL_MEMORY(blocks[0].account, roots[0], BIN_256);
+    nanoparse_block_root(&blocks[1], roots[1]);
+    TEST_ASSERT_EQUAL_MEMORY(blocks[1].previous, roots[1], BIN_256);
+
+    res = nanoparse_blocks_work_validate(blocks, 2, 0, valid);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    blocks[0].work++;
+    res = nanoparse_blocks_work_validate(blocks, 2, 0, valid);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+    TEST_ASSERT_FALSE(valid[0]);
+    TEST_ASSERT_TRUE(valid[1]);
+
+    // An open block parsed over another block keeps its stale previous
+    res = nanoparse_block(json_open, &blocks[1]);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    nanoparse_block_root(&blocks[1], roots[1]);
+    TEST_ASSERT_EQUAL_MEMORY(blocks[1].account, roots[1], BIN_256);
+    res = nanoparse_blocks_work_validate(&blocks[1], 1, 0, valid);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+
+    nl_block_free(&blocks[0]);
+    nl_block_free(&blocks[1]);
+}
+
+TEST_CASE("Block Signature Verification", TEST_TAG){
+    nl_block_t blocks[40];
+    bool valid[40];
+    uint256_t hash, expected;
+    jolt_err_t res;
+    const char *json_open = "{\"contents\": {\"type\": \"open\", \"source\": \"32E0D2FE367522FBFA29EB93940EC3AE5E1315DD9C6A73B3DE2A8BC683B64367\", \"representative\": \"xrb_3hd4ezdgsp15iemx7h81in7xz5tpxi43b6b41zn3qmwiuypankocw3awes5k\", \"account\": \"xrb_3dmtrrws3pocycmbqwawk6xs7446qxa36fcncush4s1pejk16ksbmakis78m\", \"work\": \"21bcc2816e10165d\", \"signature\": \"2CA07C59BF80B04515D49480EF0B5918BA29F998AB84120BB4B33A1A49BC028F0DB86CED729BF17B2CFF64F92011DC7F0089CDBF283C392F242A9F42DFA66000\"}}";
+    const char *json_state = "{\"contents\": {\"type\": \"state\", \"account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\", \"previous\": \"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\", \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\", \"balance\": \"0\", \"link\": \"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\", \"signature\": \"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\", \"work\": \"6aa2c8a6e053c0d4\"}}";
+
+    for( uint8_t i = 0; i < 40; i++ ) {
+        nl_block_init(&blocks[i]);
+        res = nanoparse_block(i % 8 ? json_state : json_open, &blocks[i]);
+        TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    }
+
+    res = nanoparse_block_hash(&blocks[1], hash);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    sodium_hex2bin(expected, sizeof(expected),
+            "EA9D15EE857E3C140884A2D3DABD1B5C51AFBB3466D0F61E733B747FDDF858B9",
+            64, NULL, NULL, NULL);
+    TEST_ASSERT_EQUAL_MEMORY(expected, hash, BIN_256);
+
+    TEST_ASSERT_EQUAL(E_SUCCESS, nanoparse_block_verify(&blocks[0]));
+    TEST_ASSERT_EQUAL(E_SUCCESS, nanoparse_block_verify(&blocks[1]));
+
+    // Several batches, with runs of blocks from the same account
+    res = nanoparse_blocks_verify(blocks, 40, 1, valid);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    res = nanoparse_blocks_verify(blocks, 40, 4, NULL);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+
+    // A bad signature fails its batch and is then pinned down on its own
+    blocks[5].signature[0] ^= 1;
+    blocks[33].previous[0] ^= 1;
+    blocks[16].signature[63] = 0xFF; // S out of range
+    res = nanoparse_blocks_verify(blocks, 40, 4, valid);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+    for( uint8_t i = 0; i < 40; i++ ) {
+        TEST_ASSERT_EQUAL(5 != i && 33 != i && 16 != i, valid[i]);
+    }
+    TEST_ASSERT_EQUAL(E_FAILURE, nanoparse_block_verify(&blocks[33]));
+
+    for( uint8_t i = 0; i < 40; i++ ) {
+        nl_block_free(&blocks[i]);
+    }
+}
+
+TEST_CASE("Parse Block and Hash", TEST_TAG){
+    /* Known hashes: signatures verify against the state, open and change
+     * hashes, and the send hash is the receive block's previous */
+    struct {
+        const char *json;
+        const char *hash;
+    } cases[] = {
+        { "{\"contents\": \"{\\n    \\\"type\\\": \\\"state\\\",\\n    \\\"account\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n    \\\"previous\\\": \\\"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\\\",\\n    \\\"representative\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n    \\\"balance\\\": \\\"0\\\",\\n    \\\"link\\\": \\\"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\\\",\\n    \\\"signature\\\": \\\"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\\\",\\n    \\\"work\\\": \\\"6aa2c8a6e053c0d4\\\"\\n}\\n\"}",
+          "EA9D15EE857E3C140884A2D3DABD1B5C51AFBB3466D0F61E733B747FDDF858B9" },
+        { "{\"contents\": {\"type\": \"open\", \"source\": \"32E0D2FE367522FBFA29EB93940EC3AE5E1315DD9C6A73B3DE2A8BC683B64367\", \"representative\": \"xrb_3hd4ezdgsp15iemx7h81in7xz5tpxi43b6b41zn3qmwiuypankocw3awes5k\", \"account\": \"xrb_3dmtrrws3pocycmbqwawk6xs7446qxa36fcncush4s1pejk16ksbmakis78m\", \"work\": \"21bcc2816e10165d\", \"signature\": \"2CA07C59BF80B04515D49480EF0B5918BA29F998AB84120BB4B33A1A49BC028F0DB86CED729BF17B2CFF64F92011DC7F0089CDBF283C392F242A9F42DFA66000\"}}",
+          "07BB0FBE58E39C2642F1BE2E7988EB9F758882376219E2033C84D1F9E6CEBFE5" },
+        { "{\"contents\": {\"type\": \"change\", \"previous\": \"AF9C1D46AAE66CC8F827904ED02D4B3D95AA98B1FF058352BA6B670BEFD40231\", \"representative\": \"xrb_1cwswatjifmjnmtu5toepkwca64m7qtuukizyjxsghujtpdr9466wjmn89d8\", \"work\": \"e8c2c556c9cfb6e2\", \"signature\": \"A039A7BF5E54B44F45A8E1AD9940A81C87CC66C04AFA738367956629A5EF49E49D297FA3CDD195BDA8373D144F9E1D4641737E7F372CEAB5AD2F3B8E9852A30D\"}}",
+          "C9A111580A21F3E63F2283DAF6450D5178BFAC2A6C38E09B76EEA9CE37EC9CE0" },
+        // The receive block below has this send block as its previous
+        { "{\"contents\": {\"type\": \"send\", \"previous\": \"66B2E0C0D2971A6372184FC851C959D4A2993749C78BA845D707873FB2C2EFDA\", \"destination\": \"xrb_3h94iuxwu48uzokokwa991a3okkwypiugsb5a1ehzwfw33dxrsuu154iw5qr\", \"balance\": \"0000000694140DC0A578AED10D000000\", \"work\": \"595ebaa13f83c1b2\", \"signature\": \"E523F20CAC1FF563F697C1D58E60FF0D72A9AC7B499799785490648E3F154FE4F464F6D7ECC4CD1A8072827E88F3D5805A8370F4A6DE06EDA8939E70E5113803\"}}",
+          "755F515E56D7AE5467D454C61304320CA7363449580DE3B40B0F51C816C9A8F9" },
+        { "{\"contents\": {\"type\": \"receive\", \"previous\": \"755F515E56D7AE5467D454C61304320CA7363449580DE3B40B0F51C816C9A8F9\", \"source\": \"58C5B5344D85AAAEF1E7980B25E93DFB4834B6185EAD9A546D43F400370E1188\", \"work\": \"0c6589b8125613d8\", \"signature\": \"14EF1B6FA1CCD0B56EC2D8213A0708701BA322C3C3CB592D5C85D005CD3D51F24F4EE5954FE3C1EB5839004B7541E742AA1F7870FD81220A02319B96105D2D04\"}}",
+          "5611C28A2EEF6112EBB35BB579B5EFF18C6AEDB5716B2CFED21348C8EC1A2EA4" },
+    };
+    uint256_t hash, expected;
+    nl_block_t block;
+    jolt_err_t res;
+
+    for( uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++ ) {
+        nl_block_init(&block);
+        res = nanoparse_block_and_hash(cases[i].json, &block, hash);
+        TEST_ASSERT_EQUAL(E_SUCCESS, res);
+        sodium_hex2bin(expected, sizeof(expected), cases[i].hash, HEX_256 - 1,
+                NULL, NULL, NULL);
+        TEST_ASSERT_EQUAL_MEMORY(expected, hash, BIN_256);
+        nl_block_free(&block);
+    }
+
+    // Same as hashing the parsed block afterwards
+    nl_block_init(&block);
+    res = nanoparse_block_and_hash(cases[2].json, &block, hash);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    res = nanoparse_block_hash(&block, expected);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_MEMORY(expected, hash, BIN_256);
+    nl_block_free(&block);
+}
+
+TEST_CASE("Compact Block", TEST_TAG){
+    static uint8_t soa_buf[2048] __attribute__((aligned(64)));
+    nanoparse_block_compact_t compact[4], loaded[4];
+    nanoparse_blocks_soa_t soa;
+    nl_block_t block, unpacked;
+    uint256_t expected;
+    jolt_err_t res;
+    const char *json_data = "{\"contents\": {\"type\": \"state\", \"account\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\", \"previous\": \"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\", \"representative\": \"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\", \"balance\": \"5606157000000000000000000000000000000\", \"link\": \"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\", \"signature\": \"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\", \"work\": \"6aa2c8a6e053c0d4\"}}";
+
+    TEST_ASSERT_EQUAL_UINT(256, sizeof(nanoparse_block_compact_t));
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)&compact[1] % 64);
+
+    nl_block_init(&block);
+    nl_block_init(&unpacked);
+    res = nanoparse_block(json_data, &block);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+
+    // Parsing straight to the compact form matches packing afterwards
+    res = nanoparse_block_compact_parse(json_data, &compact[0]);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    res = nanoparse_block_to_compact(&compact[1], &block, NULL);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_MEMORY(&compact[0], &compact[1], sizeof(compact[0]));
+    res = nanoparse_block_hash(&block, expected);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_MEMORY(expected, compact[0].hash, BIN_256);
+
+    res = nanoparse_block_from_compact(&unpacked, &compact[0]);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(nl_block_equal(&block, &unpacked));
+
+    // Plain copies are complete blocks
+    for( uint8_t i = 1; i < 4; i++ ) {
+        compact[i] = compact[0];
+        compact[i].work += i;
+    }
+
+    TEST_ASSERT_TRUE(nanoparse_blocks_soa_size(4) <= sizeof(soa_buf));
+    nanoparse_blocks_soa_init(&soa, soa_buf, 4);
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)soa.type % 64);
+    res = nanoparse_blocks_soa_store(&soa, 0, compact, 4);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(compact[2].work == soa.work[2]);
+    TEST_ASSERT_EQUAL_MEMORY(compact[3].previous, soa.previous[3], BIN_256);
+    res = nanoparse_blocks_soa_load(&soa, 0, loaded, 4);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL_MEMORY(compact, loaded, sizeof(compact));
+
+    res = nanoparse_blocks_soa_store(&soa, 2, compact, 3);
+    TEST_ASSERT_EQUAL(E_INSUFFICIENT_BUF, res);
+    res = nanoparse_blocks_soa_load(&soa, 5, loaded, 0);
+    TEST_ASSERT_EQUAL(E_INSUFFICIENT_BUF, res);
+
+    nl_block_free(&block);
+    nl_block_free(&unpacked);
+}
+
+TEST_CASE("Partial Block Parse", TEST_TAG){
+    const char *cases[] = {
+        "{\"contents\": \"{\\n    \\\"type\\\": \\\"state\\\",\\n    \\\"account\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n    \\\"previous\\\": \\\"6736060E4780522B1B89F5FFBE337CF5854171A06438E4929E4FEFC9211DA655\\\",\\n    \\\"representative\\\": \\\"xrb_1qzafeo4zpe6oykprr6oyb7jqgbkmezwfwzu3r99jbtfx8jyqe4p14h4d7pb\\\",\\n    \\\"balance\\\": \\\"5606157000000000000000000000000000000\\\",\\n    \\\"link\\\": \\\"5FE86B2A2FD984AFA56C6095F24B1BB9329B3FC6F3FB0E0E78A74DE9A3EBB056\\\",\\n    \\\"signature\\\": \\\"A8702746CFE1F43F0C9AC427381A06F279B578F175FFB3111394AAFB8846DB8E9310976956AC1A2156BF75A462A195DD5574AD35975F262377573B46E2B62904\\\",\\n    \\\"work\\\": \\\"6aa2c8a6e053c0d4\\\"\\n}\\n\"}",
+        "{\"contents\": {\"type\": \"send\", \"previous\": \"66B2E0C0D2971A6372184FC851C959D4A2993749C78BA845D707873FB2C2EFDA\", \"destination\": \"xrb_3h94iuxwu48uzokokwa991a3okkwypiugsb5a1ehzwfw33dxrsuu154iw5qr\", \"balance\": \"0000000694140DC0A578AED10D000000\", \"work\": \"595ebaa13f83c1b2\", \"signature\": \"E523F20CAC1FF563F697C1D58E60FF0D72A9AC7B499799785490648E3F154FE4F464F6D7ECC4CD1A8072827E88F3D5805A8370F4A6DE06EDA8939E70E5113803\"}}",
+    };
+    uint8_t zero[BIN_512] = { 0 };
+    nanoparse_block_lazy_t lazy;
+    nl_block_t block, expected;
+    jolt_err_t res;
+
+    for( uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++ ) {
+        nl_block_init(&block);
+        nl_block_init(&expected);
+        res = nanoparse_block(cases[i], &expected);
+        TEST_ASSERT_EQUAL(E_SUCCESS, res);
+
+        // Only previous and balance are decoded
+        res = nanoparse_block_partial(cases[i],
+                NANOPARSE_BLOCK_PREVIOUS | NANOPARSE_BLOCK_BALANCE, &block, &lazy);
+        TEST_ASSERT_EQUAL(E_SUCCESS, res);
+        TEST_ASSERT_EQUAL(expected.type, block.type);
+        TEST_ASSERT_EQUAL_MEMORY(expected.previous, block.previous, BIN_256);
+        TEST_ASSERT_EQUAL(0, mbedtls_mpi_cmp_mpi(&expected.balance, &block.balance));
+        TEST_ASSERT_EQUAL_MEMORY(zero, block.link, BIN_256);
+        TEST_ASSERT_EQUAL_MEMORY(zero, block.signature, BIN_512);
+        TEST_ASSERT_TRUE(0 == block.work);
+
+        // The skipped fields decode later to the same block
+        TEST_ASSERT_EQUAL_UINT8(NANOPARSE_BLOCK_ALL & ~(NANOPARSE_BLOCK_PREVIOUS
+                    | NANOPARSE_BLOCK_BALANCE) & (STATE == block.type ? 0xFF
+                    : ~(NANOPARSE_BLOCK_ACCOUNT | NANOPARSE_BLOCK_REPRESENTATIVE)),
+                lazy.pending);
+        res = nanoparse_block_lazy_decode(&lazy, NANOPARSE_BLOCK_LINK, &block);
+        TEST_ASSERT_EQUAL(E_SUCCESS, res);
+        TEST_ASSERT_EQUAL_MEMORY(expected.link, block.link, BIN_256);
+        TEST_ASSERT_EQUAL_UINT8(0, lazy.pending & NANOPARSE_BLOCK_LINK);
+        res = nanoparse_block_lazy_decode(&lazy, NANOPARSE_BLOCK_ALL, &block);
+        TEST_ASSERT_EQUAL(E_SUCCESS, res);
+        TEST_ASSERT_EQUAL_UINT8(0, lazy.pending);
+        TEST_ASSERT_TRUE(nl_block_equal(&expected, &block));
+
+        nl_block_free(&block);
+        nl_block_free(&expected);
+    }
+
+    // Without lazy, skipped fields are dropped
+    nl_block_init(&block);
+    res = nanoparse_block_partial(cases[0], NANOPARSE_BLOCK_WORK, &block, NULL);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_TRUE(0x6aa2c8a6e053c0d4 == block.work);
+    TEST_ASSERT_EQUAL_MEMORY(zero, block.previous, BIN_256);
+    nl_block_free(&block);
+
+    // Mandatory fields must still be present
+    nl_block_init(&block);
+    res = nanoparse_block_partial("{\"contents\": {\"type\": \"change\", \"representative\": \"xrb_1cwswatjifmjnmtu5toepkwca64m7qtuukizyjxsghujtpdr9466wjmn89d8\"}}",
+            NANOPARSE_BLOCK_REPRESENTATIVE, &block, NULL);
+    TEST_ASSERT_EQUAL(E_FAILURE, res);
+    nl_block_free(&block);
+}
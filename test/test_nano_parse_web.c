@@ -148,4 +148,48 @@ TEST_CASE("WiFi Account Frontier Block", TEST_TAG){
     nl_block_free( &gt );
     nl_block_free( &pred );
 }
+
+#define N_WEB_PENDING 120
+
+typedef struct {
+    uint256_t burn;
+    size_t n_burn;
+} web_pending_ctx_t;
+
+static jolt_err_t web_pending_cb(const uint256_t account,
+        const uint256_t block_hash, const nanoparse_amount_t *amount,
+        const uint256_t source, void *ctx){
+    web_pending_ctx_t *c = ctx;
+
+    if( 0 == memcmp(account, c->burn, sizeof(c->burn)) ) {
+        c->n_burn++;
+    }
+    return E_SUCCESS;
+}
+
+TEST_CASE("WiFi Accounts Pending (chunked)", TEST_TAG){
+    /* Far more accounts than fit in one command; the burn account, which
+     * always has pending blocks, is last so only the final chunk has it */
+    static char addresses[N_WEB_PENDING][ADDRESS_BUF_LEN];
+    const char *accounts[N_WEB_PENDING];
+    web_pending_ctx_t ctx = { 0 };
+    jolt_err_t res;
+
+    wifi_setup();
+    for( size_t i = 0; i < N_WEB_PENDING - 1; i++ ) {
+        uint256_t public_key;
+        memset(public_key, i + 1, sizeof(public_key));
+        nl_public_to_address(addresses[i], sizeof(addresses[i]), public_key);
+        accounts[i] = addresses[i];
+    }
+    strcpy(addresses[N_WEB_PENDING - 1],
+            "xrb_1111111111111111111111111111111111111111111111111111hifc8npp");
+    accounts[N_WEB_PENDING - 1] = addresses[N_WEB_PENDING - 1];
+    nl_address_to_public(ctx.burn, accounts[N_WEB_PENDING - 1]);
+
+    res = nanoparse_web_accounts_pending(accounts, N_WEB_PENDING, 1,
+            web_pending_cb, &ctx);
+    TEST_ASSERT_EQUAL(E_SUCCESS, res);
+    TEST_ASSERT_EQUAL(1, ctx.n_burn);
+}
 #endif